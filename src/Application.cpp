@@ -1,20 +1,27 @@
+#include <algorithm>
 #include <thread>
 #include <cstring>
+#include <cmath>
+#include <filesystem>
+#include <utility>
 
 #include <GLFW/glfw3.h>
 #include <cglm/struct/affine-pre.h>
+#include <cglm/struct/frustum.h>
 #include <stb_image.h>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
 #include "vulkan_api/utils/Helpers.hpp"
 #include "vulkan_api/pipeline/stages/shader/ShaderStage.hpp"
 #include "vulkan_api/render/Render.hpp"
+#include "utils/Trace.hpp"
 #include "Camera.hpp"
 
 #include "Application.hpp"
 
 
-#define FPS_MEASUREMENT
-
 using Clock = std::chrono::high_resolution_clock;
 using TimeStamp = std::chrono::time_point<Clock>;
 
@@ -47,14 +54,138 @@ void processInput(GLFWwindow *window, float dt)
 }
 
 
-int Application::run() noexcept
+// world space positions of our cubes
+static const std::array<vec3s, 10> cubePositions =
 {
-    initWindow();
+    vec3s { 0.0f,  0.0f,  0.0f },
+    vec3s { 2.0f,  5.0f, -15.0f },
+    vec3s { -1.5f, -2.2f, -2.5f },
+    vec3s { -3.8f, -2.0f, -12.3f },
+    vec3s { 2.4f, -0.4f, -3.5f },
+    vec3s { -1.7f,  3.0f, -7.5f },
+    vec3s { 1.3f, -2.0f, -2.5f },
+    vec3s { 1.5f,  2.0f, -2.5f },
+    vec3s { 1.5f,  0.2f, -1.5f },
+    vec3s { -1.3f,  1.0f, -1.5f }
+};
+
+
+// the hand-placed cubes first, everything beyond them goes into a grid behind the camera target
+static std::vector<vec3s> generateCubePositions(uint32_t count) noexcept
+{
+    std::vector<vec3s> positions;
+    positions.reserve(count);
+
+    for (size_t i = 0; i < cubePositions.size() && positions.size() < count; ++i)
+        positions.push_back(cubePositions[i]);
+
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(count))));
+    const float spacing = 2.f;
+
+    for (uint32_t i = 0; positions.size() < count; ++i)
+    {
+        const uint32_t x = i % side;
+        const uint32_t y = (i / side) % side;
+        const uint32_t z = i / (side * side);
+
+        positions.push_back(vec3s
+        {
+            (x - 0.5f * side) * spacing,
+            (y - 0.5f * side) * spacing,
+            -20.f - z * spacing
+        });
+    }
+
+    return positions;
+}
+
+
+// slot 0 of the texture table is the grey placeholder shown while textures stream in,
+// the flat colored checkers follow and the streamed container texture comes last
+static const std::array<uint32_t, 4> checkerColors =
+{
+    0xFF808080U, // 0xAABBGGRR, RGBA8 in memory on little endian: grey placeholder
+    0xFF2A8CE0U, // orange
+    0xFF9CB02EU, // teal
+    0xFFB04A8EU  // purple
+};
+
+
+static std::vector<uint32_t> generateCheckerPixels(uint32_t size, uint32_t color) noexcept
+{
+    std::vector<uint32_t> pixels(size * size);
+    const uint32_t cell = size / 8;
+
+    for (uint32_t y = 0; y < size; ++y)
+        for (uint32_t x = 0; x < size; ++x)
+            pixels[y * size + x] = (((x / cell) + (y / cell)) & 1) ? color : 0xFFFFFFFFU;
+
+    return pixels;
+}
+
+
+// matches the push constant block of vertex_shader.vert
+struct DrawConstants
+{
+    mat4s    modelViewProjection;
+    uint32_t textureIndex;
+};
+
+
+// matches the push constant block of frustum_cull.comp
+struct CullConstants
+{
+    vec4s    frustumPlanes[6];
+    uint32_t objectCount;
+    uint32_t indexCount;
+};
+
+
+// constant_id values of the shaders
+static constexpr uint32_t TEXTURED_CONSTANT_ID = 0; // fragment_shader.frag
+static constexpr uint32_t CULL_GROUP_SIZE_ID   = 0; // local_size_x_id of frustum_cull.comp
+static constexpr uint32_t CULL_GROUP_SIZE      = 64;
+
+
+int Application::run(const LaunchOptions& options) noexcept
+{
+    m_options = options;
+
+    {
+        const auto positions = generateCubePositions(m_options.cubeCount);
+
+        m_transforms.reserve(positions.size());
+
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            const float angle = 20.f * i;
+            m_transforms.push(positions[i], glms_quatv(glm_rad(angle), vec3s {1.0f, 0.3f, 0.5f}), glms_vec3_one());
+        }
+
+        m_mvps.resize(m_transforms.size());
+    }
+
+    if(m_options.benchmark)
+        m_benchmark = std::make_unique<FrameBenchmark>(m_options.benchmarkSettings);
+
+    if(!m_options.headless)
+        initWindow();
 
     if(initVulkan())
     {
         mainLoop();
+
+        const bool dumped   = !m_options.dumpPath || dumpFrame(m_options.dumpPath);
+        const bool reported = !m_benchmark || writeBenchmarkReport();
+
         cleanup();
+
+//      the streamer, compiler and recording threads are joined by cleanup(), nothing traces after it
+        if(m_options.tracePath)
+            TRACE_WRITE(m_options.tracePath);
+
+        if(!dumped || !reported)
+            return -1;
     }
     else return -1;
 
@@ -95,6 +226,13 @@ void Application::initWindow() noexcept
             camera.ProcessMouseMovement(xoffset, yoffset);
         });
 
+        glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int, int action, int)
+        {
+            if(key == GLFW_KEY_F && action == GLFW_PRESS)
+                if(auto app = static_cast<Application*>(glfwGetWindowUserPointer(window)))
+                    app->toggleWireframe();
+        });
+
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
 }
@@ -102,77 +240,113 @@ void Application::initWindow() noexcept
 
 bool Application::initVulkan() noexcept
 {
-    glfwGetFramebufferSize(window, &m_width, &m_height);
+    TRACE_SCOPE("initVulkan");
+
+    if(m_options.headless)
+    {
+        m_width  = WIDTH;
+        m_height = HEIGHT;
+    }
+    else glfwGetFramebufferSize(window, &m_width, &m_height);
 
 //  Common
-    if(m_context.initialize() != VK_SUCCESS) 
+    if(m_context.initialize(m_options.headless, m_options.headlessSurface) != VK_SUCCESS) 
         return false;
 
     auto instance = m_context.getInstance();
     auto GPU      = m_context.getPhysicalDevice();
     auto device   = m_context.getDevice();
 
+//  Assets, one mapping instead of a file open per shader and texture
+    if(m_assets.open("res/assets.pak"))
+    {
+        printf("asset archive: %u files, %llu KiB mapped\n", m_assets.getEntryCount(), static_cast<unsigned long long>(m_assets.getSize() >> 10));
+
+#ifdef DEBUG
+        if(const uint32_t corrupted = m_assets.verify(); corrupted != 0)
+            printf("asset archive: %u files do not match their hash\n", corrupted);
+#endif
+    }
+    else printf("asset archive not found, loading loose files\n");
+
 //  Main View
-    if(m_mainView.create(m_context, window) != VK_SUCCESS) 
+    if(m_options.headless)
+    {
+        const VkExtent2D extent = { static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height) };
+
+        if(m_mainView.createHeadless(m_context, extent, m_options.headlessSurface) != VK_SUCCESS)
+            return false;
+    }
+    else if(m_mainView.create(m_context, window) != VK_SUCCESS) 
         return false;
     
-    {// Pipeline
-        std::array<ShaderStage, 2> shaders;
+    const bool indirect  = (m_options.renderMode == LaunchOptions::RenderMode::Indirect);
+    const bool instanced = (m_options.renderMode == LaunchOptions::RenderMode::Instanced) || indirect;
 
-        if(shaders[0].loadFromFile(device, VK_SHADER_STAGE_VERTEX_BIT, "res/shaders/vertex_shader.spv") != VK_SUCCESS)
-            return false;
+    if(indirect)
+    {
+        const auto& features = m_context.getFeatures();
 
-        if(shaders[1].loadFromFile(device, VK_SHADER_STAGE_FRAGMENT_BIT, "res/shaders/fragment_shader.spv") != VK_SUCCESS)
+        if(!features.drawIndirectCount || !features.drawIndirectFirstInstance || !features.multiDrawIndirect)
+        {
+            printf("indirect mode requires drawIndirectCount, drawIndirectFirstInstance and multiDrawIndirect\n");
             return false;
+        }
+    }
 
-        std::array<const VertexInputState::Attribute, 2> attributes =
-        {
-            VertexInputState::Attribute::Float3,
-            VertexInputState::Attribute::Float2
-        };
+    if(!m_context.getFeatures().descriptorIndexing)
+    {
+        printf("the texture table requires descriptor indexing: runtime arrays, partially bound and update-after-bind sampled images\n");
+        return false;
+    }
+
+    if(!m_textureTable.create(GPU, device))
+        return false;
 
-        DescriptorSetLayout uniformDescriptors;
-        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+    {// Pipeline
+        const char* vertexShader = instanced ? "res/shaders/instanced_vertex_shader.spv" : "res/shaders/vertex_shader.spv";
 
-        GraphicsPipeline::State state;
+        if(loadShader(m_shaders[0], VK_SHADER_STAGE_VERTEX_BIT, vertexShader) != VK_SUCCESS)
+            return false;
 
-        state.setupShaderStages(shaders)->
-            setupVertexInput(attributes)->
-            setupInputAssembler(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)->
-            setupViewport()->
-            setupRasterization(VK_POLYGON_MODE_FILL)->
-            setupMultisampling()->
-            setupColorBlending(VK_FALSE)->
-            setupDescriptorSetLayout(uniformDescriptors);
+        if(loadShader(m_shaders[1], VK_SHADER_STAGE_FRAGMENT_BIT, "res/shaders/fragment_shader.spv") != VK_SUCCESS)
+            return false;
 
+        if(m_options.dynamicState && !(m_context.getFeatures().extendedDynamicState && m_dynamicState.create(device)))
+            printf("dynamic state requires VK_EXT_extended_dynamic_state3 with polygon mode and color blend enable, variants get their own pipelines\n");
 
-        if(m_pipeline.create(m_mainView, state) != VK_SUCCESS) 
+//      the filled pipeline is built right away, every other variant compiles in the background when first asked for
+        m_pipeline = m_context.getPipelineRegistry().getGraphicsPipeline(m_mainView, makePipelineState(VK_POLYGON_MODE_FILL));
+
+        if(!m_pipeline)
             return false;
 
-        shaders[0].destroy(device);
-        shaders[1].destroy(device);
+        if(!m_pipelineCompiler.create(1))
+            return false;
 
-        m_descriptorPool = std::make_unique<DescriptorPool>(device);
+        if(m_options.wireframe)
+            toggleWireframe();
 
+        if(instanced)
         {
+            m_descriptorPool = std::make_unique<DescriptorPool>(device);
+
             std::array<VkDescriptorPoolSize, 1> poolSizes = 
             {
                 VkDescriptorPoolSize
                 {
-                    .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = MAX_FRAMES_IN_FLIGHT
+                    .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 2 * MAX_FRAMES_IN_FLIGHT
                 }
             };
 
             if(m_descriptorPool->create(poolSizes) != VK_SUCCESS)
                 return false;
-        }
 
-        {
             std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts = 
             { 
-                m_pipeline.getDescriptorSetLayout(), 
-                m_pipeline.getDescriptorSetLayout() 
+                m_pipeline->getDescriptorSetLayout(), 
+                m_pipeline->getDescriptorSetLayout() 
             };
 
             if(m_descriptorPool->allocateDescriptorSets(m_descriptorSets, layouts) != VK_SUCCESS)
@@ -183,25 +357,71 @@ bool Application::initVulkan() noexcept
     if(!m_commandPool.create(device, m_context.getMainQueueFamilyIndex()))
         return false;
 
-    if(!m_sync.create(device)) 
+    if(m_options.recordThreads > 1 && m_options.renderMode == LaunchOptions::RenderMode::Legacy)
+    {
+        if(!m_threadCommandPools.create(device, m_context.getMainQueueFamilyIndex(), m_options.recordThreads))
+            return false;
+
+        m_recordPool = std::make_unique<ThreadPool>(m_options.recordThreads);
+        m_threadCounters.resize(m_options.recordThreads);
+        m_threadResults.resize(m_options.recordThreads);
+    }
+
+    if(!m_sync.create(device, m_context.getFeatures().dedicatedTransferQueue)) 
         return false;
 
-    auto queue = m_context.getQueue();
-    auto commandPool = m_commandPool.handle;
+    if(!m_profiler.create(GPU, device, m_context.getMainQueueFamilyIndex()))
+        printf("timestamp queries are not supported on this queue, GPU timings are disabled\n");
 
-    {
-        if(!m_texture.loadFromFile("res/textures/container.jpg", GPU, device, commandPool, queue))
-            return false;
-                
-        VkDescriptorImageInfo imageInfo = 
+    {// secondary command buffers can only contribute to a query of the primary with inheritedQueries
+        const auto& features = m_context.getFeatures();
+        const bool supported = features.pipelineStatisticsQuery && (!m_recordPool || features.inheritedQueries);
+
+        if(!supported || !m_pipelineStatistics.create(device))
+            printf("pipeline statistics queries are not available, GPU work counters are disabled\n");
+    }
+
+    if(!m_staging.create(GPU, m_context.getAllocator()))
+        return false;
+
+    if(!m_uploads.begin(m_context.getAllocator(), device, m_commandPool.handle, &m_staging))
+        return false;
+
+    {// Texture table
+        m_textures.resize(checkerColors.size());
+
+        for (size_t i = 0; i < checkerColors.size(); ++i)
         {
-            .sampler     = m_texture.getSampler(),
-            .imageView   = m_texture.getImageView(),
-            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-        };
+            const uint32_t size = 64;
+            const auto pixels = generateCheckerPixels(size, checkerColors[i]);
+
+            if(!m_textures[i].create(pixels.data(), size, size, GPU, device, m_context.getAllocator(), m_uploads, m_options.mipmaps))
+                return false;
+        }
+
+        for (const auto& texture : m_textures)
+            if(m_textureTable.add(device, texture.getImageView(), texture.getSampler()) == TextureTable::INVALID_INDEX)
+                return false;
+
+        const uint32_t workerCount = std::max(1U, std::thread::hardware_concurrency() / 2);
+
+        if(!m_streamer.create(m_context, m_textureTable, m_textures[0], m_staging, m_sync, workerCount, &m_assets))
+            return false;
+
+//      a precompressed copy skips the decode and takes a fraction of the memory
+        const bool precompressed = m_assets.contains("res/textures/container.ktx2") || std::filesystem::exists("res/textures/container.ktx2");
+        const char* streamedPath = precompressed ? "res/textures/container.ktx2" : "res/textures/container.jpg";
+        m_streamedSlot = m_streamer.request(streamedPath, m_options.mipmaps);
+
+        if(m_streamedSlot == TextureTable::INVALID_INDEX)
+            return false;
+
+//      cubes cycle through every slot but the placeholder
+        const uint32_t textureCount = m_textureTable.getCount() - 1;
+        m_textureIndices.resize(m_transforms.size());
 
-        m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_descriptorSets[0], 0);
-        m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_descriptorSets[1], 0);
+        for (size_t i = 0; i < m_textureIndices.size(); ++i)
+            m_textureIndices[i] = 1 + static_cast<uint32_t>(i % textureCount);
     }
 
     {
@@ -248,9 +468,193 @@ bool Application::initVulkan() noexcept
             20, 21, 22, 22, 23, 20   // bottom
         };
 
-        m_holder = std::make_unique<VkResourceHolder>(GPU, device, queue, commandPool);
-        m_vertices = m_holder->createBuffer<float>(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT); // TODO вынести флаг в constexpr условие со static_assert
-        m_indices = m_holder->createBuffer<uint32_t>(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        const bool direct = m_context.getFeatures().hostVisibleDeviceMemory && !m_options.stagedUpload;
+        m_holder = std::make_unique<VkResourceHolder>(m_context.getAllocator(), direct ? VkResourceHolder::UploadPath::Direct : VkResourceHolder::UploadPath::Staged);
+        m_vertices = m_holder->createBuffer<float>(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_uploads); // TODO вынести флаг в constexpr условие со static_assert
+        m_indices = m_holder->createBuffer<uint32_t>(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_uploads);
+    }
+
+    if(instanced)
+    {// Per-instance model matrices, uploaded once and indexed by gl_InstanceIndex
+        const uint32_t count = static_cast<uint32_t>(m_transforms.size());
+
+        m_instances = m_holder->createBuffer<mat4s>(count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, m_uploads, [this, count](mat4s* dst)
+        {
+            m_transforms.writeModelMatrices(&dst->raw[0][0], 0, count);
+        });
+
+        if(!m_instances.handle)
+            return false;
+
+        m_materials = m_holder->createBuffer<uint32_t>(m_textureIndices, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, m_uploads);
+
+        if(!m_materials.handle)
+            return false;
+
+        VkDescriptorBufferInfo bufferInfo = 
+        {
+            .buffer = m_instances.handle,
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE
+        };
+
+        VkDescriptorBufferInfo materialInfo = 
+        {
+            .buffer = m_materials.handle,
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE
+        };
+
+        for (auto descriptorSet : m_descriptorSets)
+        {
+            m_descriptorPool->writeStorageBuffer(&bufferInfo, descriptorSet, 0);
+            m_descriptorPool->writeStorageBuffer(&materialInfo, descriptorSet, 1);
+        }
+    }
+
+    if(indirect && !initCulling())
+        return false;
+
+//  the first frame is submitted to the same queue after the batch, so nothing waits for it here
+    if(!m_uploads.submit(m_context.getQueue(), m_sync.graphicsTimeline))
+        return false;
+
+    printf("startup uploads: %u commands, %llu KiB staged, %llu KiB of it in dedicated buffers\n",
+        m_uploads.getCommandCount(),
+        static_cast<unsigned long long>(m_uploads.getStagingSize() / 1024),
+        static_cast<unsigned long long>(m_uploads.getDedicatedSize() / 1024));
+
+    const auto& uploadStats = m_holder->getUploadStats();
+    printf("buffer uploads: %s path, %u direct (%llu KiB), %u staged (%llu KiB)\n",
+        (m_holder->getUploadPath() == VkResourceHolder::UploadPath::Direct) ? "direct" : "staged",
+        uploadStats.directCount,
+        static_cast<unsigned long long>(uploadStats.directBytes / 1024),
+        uploadStats.stagedCount,
+        static_cast<unsigned long long>(uploadStats.stagedBytes / 1024));
+
+    const auto pipelines = m_context.getPipelineCache().getStats();
+    printf("pipelines: %u created in %.2f ms from a %s cache (%llu KiB loaded)\n",
+        pipelines.pipelineCount,
+        pipelines.creationTime,
+        pipelines.warm ? "warm" : "cold",
+        static_cast<unsigned long long>(pipelines.loadedBytes / 1024));
+
+    const auto registry = m_context.getPipelineRegistry().getStats();
+    printf("pipeline registry: %u pipelines, %u set layouts, %u pipeline layouts, %u lookups hit, %u missed\n",
+        registry.pipelines,
+        registry.descriptorSetLayouts,
+        registry.pipelineLayouts,
+        registry.hits,
+        registry.misses);
+
+    const auto memory = m_context.getAllocator().getStats();
+    printf("device memory: %u allocations in %u blocks + %u dedicated, %llu KiB used of %llu KiB reserved, %llu KiB fragmented\n",
+        memory.allocationCount,
+        memory.blockCount,
+        memory.dedicatedCount,
+        static_cast<unsigned long long>(memory.usedBytes / 1024),
+        static_cast<unsigned long long>(memory.reservedBytes / 1024),
+        static_cast<unsigned long long>(memory.fragmentedBytes / 1024));
+
+    const auto heaps = m_context.getAllocator().getHeapBudgets();
+
+    for (size_t i = 0; i < heaps.size(); ++i)
+        printf("heap %zu%s: %llu MiB used of %llu MiB budget, %llu MiB heap, %llu MiB reserved here\n",
+            i,
+            heaps[i].deviceLocal ? " (device local)" : "",
+            static_cast<unsigned long long>(heaps[i].usage >> 20),
+            static_cast<unsigned long long>(heaps[i].budget >> 20),
+            static_cast<unsigned long long>(heaps[i].size >> 20),
+            static_cast<unsigned long long>(heaps[i].reserved >> 20));
+
+    return true;
+}
+
+
+bool Application::initCulling() noexcept
+{
+    auto device = m_context.getDevice();
+
+    {// Pipeline
+        ShaderStage shader;
+
+        if(loadShader(shader, VK_SHADER_STAGE_COMPUTE_BIT, "res/shaders/frustum_cull.spv") != VK_SUCCESS)
+            return false;
+
+        shader.setSpecialization(SpecializationConstants().set(CULL_GROUP_SIZE_ID, CULL_GROUP_SIZE));
+
+        DescriptorSetLayout descriptors;
+        descriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // model matrices
+        descriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // draw commands
+        descriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // draw count
+
+        const VkResult result = m_cullPipeline.create(m_context.getPipelineCache(), shader, descriptors, sizeof(CullConstants));
+        shader.destroy(device);
+
+        if(result != VK_SUCCESS)
+            return false;
+    }
+
+    m_cullDescriptorPool = std::make_unique<DescriptorPool>(device);
+
+    {
+        std::array<VkDescriptorPoolSize, 1> poolSizes = 
+        {
+            VkDescriptorPoolSize
+            {
+                .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 3 * MAX_FRAMES_IN_FLIGHT
+            }
+        };
+
+        if(m_cullDescriptorPool->create(poolSizes) != VK_SUCCESS)
+            return false;
+    }
+
+    {
+        std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts = 
+        { 
+            m_cullPipeline.getDescriptorSetLayout(), 
+            m_cullPipeline.getDescriptorSetLayout() 
+        };
+
+        if(m_cullDescriptorPool->allocateDescriptorSets(m_cullDescriptorSets, layouts) != VK_SUCCESS)
+            return false;
+    }
+
+    const VkDescriptorBufferInfo instancesInfo = 
+    {
+        .buffer = m_instances.handle,
+        .offset = 0,
+        .range  = VK_WHOLE_SIZE
+    };
+
+    // one command + count buffer per frame in flight, so culling never overwrites what the previous frame still draws from
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        m_drawCommands[i] = m_holder->createBuffer<VkDrawIndexedIndirectCommand>(m_instances.size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+        m_drawCounts[i]   = m_holder->createBuffer<uint32_t>(1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+        if(!m_drawCommands[i].handle || !m_drawCounts[i].handle)
+            return false;
+
+        const VkDescriptorBufferInfo commandsInfo = 
+        {
+            .buffer = m_drawCommands[i].handle,
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE
+        };
+
+        const VkDescriptorBufferInfo countInfo = 
+        {
+            .buffer = m_drawCounts[i].handle,
+            .offset = 0,
+            .range  = VK_WHOLE_SIZE
+        };
+
+        m_cullDescriptorPool->writeStorageBuffer(&instancesInfo, m_cullDescriptorSets[i], 0);
+        m_cullDescriptorPool->writeStorageBuffer(&commandsInfo, m_cullDescriptorSets[i], 1);
+        m_cullDescriptorPool->writeStorageBuffer(&countInfo, m_cullDescriptorSets[i], 2);
     }
 
     return true;
@@ -263,45 +667,53 @@ void Application::mainLoop() noexcept
 
     float deltaTime = 0.f;
     float lastFrame = 0.f;
+    uint32_t frames = 0;
 
-#ifdef FPS_MEASUREMENT
-    float timer = 0;
-    int fps = 0;
-#endif
-
-    while (!glfwWindowShouldClose(window))
+    auto keep_running = [this, &frames]() -> bool
     {
-#ifndef FPS_MEASUREMENT
-        const auto dt = Clock::now() - timestamp;
-
-        if (dt < std::chrono::milliseconds(16)) // 60 FPS regulation
-        { 
-           std::this_thread::sleep_for(std::chrono::milliseconds(1));
-           continue;
-        }
+        if(window && glfwWindowShouldClose(window))
+            return false;
 
-        timestamp = Clock::now();
-#endif
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        if(m_benchmark)
+            return !m_benchmark->isFinished();
 
-#ifdef FPS_MEASUREMENT
-        timer += deltaTime;
-        ++fps;
+        return m_options.frameCount == 0 || frames < m_options.frameCount;
+    };
 
-        if (timer > 1.f)
+    while (keep_running())
+    {
+        if(window)
         {
-            printf("FPS: %i\n", fps);
-            timer = 0;
-            fps = 0;
+            if(!m_benchmark)
+            {
+                const auto dt = Clock::now() - timestamp;
+
+                if (dt < std::chrono::milliseconds(16)) // 60 FPS regulation
+                { 
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+
+                timestamp = Clock::now();
+            }
+
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
 
+            processInput(window, deltaTime);
+            glfwPollEvents();
         }
-#endif
-        processInput(window, deltaTime);
 
-        glfwPollEvents();
+        if(m_benchmark)
+            m_benchmark->beginFrame();
+
         drawFrame();
+
+        if(m_benchmark)
+            m_benchmark->endFrame();
+
+        ++frames;
     }
 
     vkDeviceWaitIdle(m_context.getDevice());
@@ -312,131 +724,637 @@ void Application::cleanup() noexcept
 {
     auto device = m_context.getDevice();
 
-    m_pipeline.destroy(device);
-    m_descriptorPool->destroy();
+//  the pipelines themselves are destroyed with the context's registry
+    m_pipelineCompiler.destroy();
+    m_pipeline.reset();
+
+    for (auto& shader : m_shaders)
+        shader.destroy(device);
+
+    if(m_descriptorPool)
+        m_descriptorPool->destroy();
+
+    m_cullPipeline.destroy(device);
+
+    if(m_cullDescriptorPool)
+        m_cullDescriptorPool->destroy();
+
+    m_uploads.destroy();
+    m_streamer.destroy(device);
+    m_staging.destroy();
+    m_assets.close();
+
+    for (auto& texture : m_textures)
+        texture.destroy(device, m_context.getAllocator());
 
-    m_texture.destroy(device);
+    m_textureTable.destroy(device);
     m_holder->cleanup();
 
+    m_profiler.destroy(device);
+    m_pipelineStatistics.destroy(device);
     m_sync.destroy(device);
 
+    m_recordPool.reset();
+    m_threadCommandPools.destroy(device);
     m_commandPool.destroy(device);
 
     m_mainView.destroy();
     m_context.destroy();
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if(window)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
 
 
 void Application::recreateSwapChain() noexcept
 {
+    TRACE_SCOPE("recreateSwapChain");
+
     vkDeviceWaitIdle(m_context.getDevice());
     m_mainView.recreate(true);
 }
 
 
-// world space positions of our cubes
-static const std::array<vec3s, 10> cubePositions =
+bool Application::dumpFrame(const char* path) noexcept
 {
-    vec3s { 0.0f,  0.0f,  0.0f },
-    vec3s { 2.0f,  5.0f, -15.0f },
-    vec3s { -1.5f, -2.2f, -2.5f },
-    vec3s { -3.8f, -2.0f, -12.3f },
-    vec3s { 2.4f, -0.4f, -3.5f },
-    vec3s { -1.7f,  3.0f, -7.5f },
-    vec3s { 1.3f, -2.0f, -2.5f },
-    vec3s { 1.5f,  2.0f, -2.5f },
-    vec3s { 1.5f,  0.2f, -1.5f },
-    vec3s { -1.3f,  1.0f, -1.5f }
-};
+    if(!m_mainView.isOffscreen())
+    {
+        printf("frame dump is only supported for offscreen render targets\n");
+        return false;
+    }
+
+    auto device = m_context.getDevice();
+    auto& allocator = m_context.getAllocator();
+    const auto& extent = m_mainView.getExtent();
+    const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    VkBuffer buffer = nullptr;
+    MemoryAllocator::Allocation memory;
 
+    if(allocator.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory) != VK_SUCCESS)
+        return false;
+
+    bool written = false;
+
+    if(vk::copyImageToBuffer(m_mainView.getImage(m_lastImageIndex), m_mainView.getFinalLayout(), buffer, extent.width, extent.height, device, m_commandPool.handle, m_context.getQueue(), m_sync.graphicsTimeline))
+    {
+        auto pixels = static_cast<uint8_t*>(memory.mapped);
+
+        if(m_mainView.getFormat() == VK_FORMAT_B8G8R8A8_SRGB)
+            for (VkDeviceSize i = 0; i < size; i += 4)
+                std::swap(pixels[i], pixels[i + 2]);
+
+        written = stbi_write_png(path, extent.width, extent.height, 4, pixels, extent.width * 4) != 0;
+    }
 
-void Application::updateUniformBuffer(vec3s pos, float angle) noexcept
+    allocator.destroyBuffer(buffer, memory);
+
+    if(written)
+        printf("frame written to %s\n", path);
+    else
+        printf("failed to write frame to %s\n", path);
+
+    return written;
+}
+
+
+bool Application::writeBenchmarkReport() const noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_context.getPhysicalDevice(), &properties);
+
+    const FrameBenchmark::RunInfo info = 
+    {
+        .renderMode    = LaunchOptions::getRenderModeName(m_options.renderMode),
+        .device        = properties.deviceName,
+        .cubeCount     = static_cast<uint32_t>(m_transforms.size()),
+        .recordThreads = m_recordPool ? m_options.recordThreads : 1,
+        .headless      = m_options.headless,
+        .mipmaps       = m_options.mipmaps,
+        .upload        = (m_holder->getUploadStats().stagedCount == 0) ? "direct" : "staged"
+    };
+
+    return m_benchmark->write(info, m_options.benchmarkOutput);
+}
+
+
+mat4s Application::computeViewProjection() const noexcept
 {
-    mat4s model = glms_translate(glms_mat4_identity(), pos);
-    model = glms_rotate(model, glm_rad(angle), vec3s {1.0f, 0.3f, 0.5f});
     auto view = camera.GetViewMatrix();
     mat4s proj = glms_perspective(glm_rad(60.f), m_width / (float)m_height, 0.1f, 100.f);
     proj.col[1].y *= -1;
 
-    m_mvp = glms_mat4_mul(glms_mat4_mul(proj, view), model); 
+    return glms_mat4_mul(proj, view);
+}
+
+
+VkResult Application::loadShader(ShaderStage& shader, VkShaderStageFlagBits stage, const char* path) const noexcept
+{
+//  archive payloads are 64-byte aligned, the SPIR-V goes to the driver without a copy
+    if(const auto code = m_assets.find(path); !code.empty())
+        return shader.loadFromMemory(m_context.getDevice(), stage, code);
+
+    return shader.loadFromFile(m_context.getDevice(), stage, path);
+}
+
+
+GraphicsPipeline::State Application::makePipelineState(VkPolygonMode mode) const noexcept
+{
+    const bool instanced = (m_options.renderMode != LaunchOptions::RenderMode::Legacy);
+
+    std::array<const VertexInputState::Attribute, 2> attributes =
+    {
+        VertexInputState::Attribute::Float3,
+        VertexInputState::Attribute::Float2
+    };
+
+//  Textures come from the texture table in set 1, set 0 only carries the per-instance data of the instanced modes
+    DescriptorSetLayout uniformDescriptors;
+
+    if(instanced)
+    {
+        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT); // model matrices
+        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT); // texture indices
+    }
+
+    GraphicsPipeline::State state;
+
+    state.setupShaderStages(m_shaders)->
+        setupVertexInput(attributes)->
+        setupInputAssembler(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)->
+        setupViewport()->
+        setupRasterization(mode)->
+        setupMultisampling()->
+        setupColorBlending(VK_FALSE)->
+        setupDescriptorSetLayout(uniformDescriptors)->
+        setupTextureTable(m_textureTable.getLayout())->
+        setupPushConstants(instanced ? sizeof(mat4s) : sizeof(DrawConstants))->
+        setupExtendedDynamicState(m_dynamicState.isEnabled());
+
+//  lines are drawn in a flat color, the sampled texture would hide them.
+//  With dynamic state the wireframe is the filled pipeline drawn with another polygon mode, so it keeps the texture
+    if(mode != VK_POLYGON_MODE_FILL && !m_dynamicState.isEnabled())
+        state.setupSpecialization(VK_SHADER_STAGE_FRAGMENT_BIT, SpecializationConstants().set(TEXTURED_CONSTANT_ID, false));
+
+    return state;
 }
 
 
-void Application::writeCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex, VkDescriptorSet descriptorSet) noexcept
+void Application::toggleWireframe() noexcept
+{
+    if(!m_context.getFeatures().fillModeNonSolid)
+    {
+        printf("wireframe rendering requires fillModeNonSolid\n");
+        return;
+    }
+
+    m_wireframe = !m_wireframe;
+
+//  the first request starts the compile, frames keep drawing filled until it is done
+    if(m_wireframe && !m_wireframePipeline.isValid())
+        m_wireframePipeline = m_pipelineCompiler.compile(m_mainView, makePipelineState(VK_POLYGON_MODE_LINE));
+}
+
+
+const GraphicsPipeline& Application::selectPipeline() const noexcept
+{
+//  every variant is built from the same layouts, so the descriptor sets and push constants of the filled pipeline fit all of them
+    if(m_wireframe)
+        if(const GraphicsPipeline* wireframe = m_wireframePipeline.get())
+            return *wireframe;
+
+    return *m_pipeline;
+}
+
+
+//  Called before every draw, the tracker of the command buffer only records the values that changed since its last draw
+void Application::writeDynamicState(VkCommandBuffer cmd, DynamicState::Tracker& tracker, CommandCounters& counters) noexcept
+{
+    if(m_dynamicState.isEnabled())
+        counters.dynamicStates += tracker.apply(cmd, m_activeDynamicState);
+}
+
+
+void Application::writeCommandBuffer(VkCommandBuffer cmd, DynamicState::Tracker& tracker, const mat4s& mvp, uint32_t textureIndex, CommandCounters& counters) noexcept
 {
     VkDeviceSize offsets[] = {0};
     VkBuffer vertexBuffers[] = {m_vertices.handle};
 
+    const DrawConstants constants = { mvp, textureIndex };
+
     vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
     vkCmdBindIndexBuffer(cmd, m_indices.handle, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdPushConstants(cmd, m_pipeline.getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s), m_mvp.raw);
+    vkCmdPushConstants(cmd, m_activePipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants), &constants);
+    writeDynamicState(cmd, tracker, counters);
     vkCmdDrawIndexed(cmd, m_indices.size, 1, 0, 0, 0);
+
+    counters.bufferBinds += 2;
+    ++counters.pushConstants;
+    ++counters.draws;
+}
+
+
+bool Application::writeSecondaryCommandBuffers(uint32_t frame, const mat4s& viewProjection, uint32_t drawScope) noexcept
+{
+    const uint32_t threadCount = m_threadCommandPools.getThreadCount();
+    const size_t cubeCount = m_transforms.size();
+    const VkDescriptorSet textureSet = m_textureTable.getSet(frame);
+
+    if(m_threadCommandPools.reset(m_context.getDevice(), frame) != VK_SUCCESS)
+        return false;
+
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        // contiguous slices executed in thread order keep the draw order of the single threaded path
+        const size_t first = cubeCount * t / threadCount;
+        const size_t last  = cubeCount * (t + 1) / threadCount;
+        VkCommandBuffer cmd = m_threadCommandPools.getCommandBuffer(frame, t);
+
+        const bool firstSlice = (t == 0);
+        const bool lastSlice  = (t + 1 == threadCount);
+
+        CommandCounters& counters = m_threadCounters[t];
+        VkResult& result = m_threadResults[t];
+        counters = {};
+        result = VK_NOT_READY;
+
+        m_recordPool->submit([this, cmd, textureSet, &viewProjection, &counters, &result, first, last, drawScope, firstSlice, lastSlice](uint32_t)
+        {
+            TRACE_SCOPE("record slice");
+
+            m_transforms.writeModelViewProjection(viewProjection, &m_mvps[first].raw[0][0], first, last - first);
+
+            const VkQueryPipelineStatisticFlags statistics = m_pipelineStatistics.isEnabled() ? PipelineStatisticsQuery::STATISTICS : 0;
+
+            if(result = Render::beginSecondary(cmd, m_mainView, statistics); result != VK_SUCCESS)
+                return;
+
+            // dynamic state is not inherited from the primary, the slice tracks its own
+            DynamicState::Tracker tracker(m_dynamicState);
+
+            // the draw scope opens in the first buffer and closes in the last, they execute in submission order
+            if(firstSlice)
+                m_profiler.writeBegin(cmd, drawScope);
+
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_activePipeline->getHandle());
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_activePipeline->getLayout(), 1, 1, &textureSet, 0, nullptr);
+            ++counters.pipelineBinds;
+            ++counters.descriptorSetBinds;
+
+            for (size_t i = first; i < last; ++i)
+                writeCommandBuffer(cmd, tracker, m_mvps[i], m_textureIndices[i], counters);
+
+            if(lastSlice)
+                m_profiler.writeEnd(cmd, drawScope);
+
+            result = Render::endSecondary(cmd);
+        });
+    }
+
+    m_recordPool->wait();
+
+    for (const auto& counters : m_threadCounters)
+        m_frameStats.commands += counters;
+
+//  a buffer that was never begun or ended must not be executed
+    return std::all_of(m_threadResults.begin(), m_threadResults.end(), [](VkResult result) { return result == VK_SUCCESS; });
+}
+
+
+void Application::writeInstancedCommandBuffer(VkCommandBuffer cmd, DynamicState::Tracker& tracker, const mat4s& viewProjection) noexcept
+{
+    VkDeviceSize offsets[] = {0};
+    VkBuffer vertexBuffers[] = {m_vertices.handle};
+
+    vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(cmd, m_indices.handle, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdPushConstants(cmd, m_activePipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s), viewProjection.raw);
+    writeDynamicState(cmd, tracker, m_frameStats.commands);
+    vkCmdDrawIndexed(cmd, m_indices.size, m_instances.size, 0, 0, 0);
+
+    m_frameStats.commands.bufferBinds += 2;
+    ++m_frameStats.commands.pushConstants;
+    ++m_frameStats.commands.draws;
+}
+
+
+void Application::writeCullingCommands(VkCommandBuffer cmd, uint32_t frame, const mat4s& viewProjection) noexcept
+{
+    CullConstants constants = {};
+    glms_frustum_planes(viewProjection, constants.frustumPlanes);
+    constants.objectCount = m_instances.size;
+    constants.indexCount  = m_indices.size;
+
+    vkCmdFillBuffer(cmd, m_drawCounts[frame].handle, 0, sizeof(uint32_t), 0);
+
+    const VkMemoryBarrier clearBarrier = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext         = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getHandle());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getLayout(), 0, 1, &m_cullDescriptorSets[frame], 0, nullptr);
+    vkCmdPushConstants(cmd, m_cullPipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+    vkCmdDispatch(cmd, (constants.objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    const VkMemoryBarrier cullBarrier = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext         = nullptr,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+    auto& counters = m_frameStats.commands;
+    counters.barriers += 2;
+    ++counters.pipelineBinds;
+    ++counters.descriptorSetBinds;
+    ++counters.pushConstants;
+    ++counters.dispatches;
+}
+
+
+void Application::writeIndirectCommandBuffer(VkCommandBuffer cmd, DynamicState::Tracker& tracker, uint32_t frame, const mat4s& viewProjection) noexcept
+{
+    VkDeviceSize offsets[] = {0};
+    VkBuffer vertexBuffers[] = {m_vertices.handle};
+
+    vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(cmd, m_indices.handle, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdPushConstants(cmd, m_activePipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s), viewProjection.raw);
+    writeDynamicState(cmd, tracker, m_frameStats.commands);
+    vkCmdDrawIndexedIndirectCount(cmd, m_drawCommands[frame].handle, 0, m_drawCounts[frame].handle, 0, m_drawCommands[frame].size, sizeof(VkDrawIndexedIndirectCommand));
+
+    m_frameStats.commands.bufferBinds += 2;
+    ++m_frameStats.commands.pushConstants;
+    ++m_frameStats.commands.draws;
+}
+
+
+bool Application::writeScenePass(VkCommandBuffer cmd, uint32_t frame, uint32_t imageIndex, const mat4s& viewProjection, uint32_t drawScope) noexcept
+{
+    // dynamic state is undefined at the start of the buffer, one tracker follows it through every draw recorded into it
+    DynamicState::Tracker tracker(m_dynamicState);
+
+    if(m_recordPool)
+    {
+        if(Render::begin(cmd, m_mainView, imageIndex, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, &m_profiler, &m_frameStats.commands) != VK_SUCCESS)
+            return false;
+
+        const auto secondaryBuffers = m_threadCommandPools.getCommandBuffers(frame);
+        vkCmdExecuteCommands(cmd, static_cast<uint32_t>(secondaryBuffers.size()), secondaryBuffers.data());
+        tracker.reset(); // the secondaries leave the dynamic state of the primary undefined
+    }
+    else
+    {
+        if(Render::begin(cmd, m_mainView, imageIndex, 0, &m_profiler, &m_frameStats.commands) != VK_SUCCESS)
+            return false;
+
+        m_profiler.writeBegin(cmd, drawScope);
+
+        // one bind covers every texture, the legacy pipeline has no per-frame set and starts at the table
+        const std::array<VkDescriptorSet, 2> descriptorSets = { m_descriptorSets[frame], m_textureTable.getSet(frame) };
+        const uint32_t firstSet = m_descriptorPool ? 0 : 1;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_activePipeline->getHandle());
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_activePipeline->getLayout(), firstSet, 2 - firstSet, descriptorSets.data() + firstSet, 0, nullptr);
+        ++m_frameStats.commands.pipelineBinds;
+        ++m_frameStats.commands.descriptorSetBinds;
+
+        switch (m_options.renderMode)
+        {
+            case LaunchOptions::RenderMode::Legacy:
+                m_transforms.writeModelViewProjection(viewProjection, &m_mvps[0].raw[0][0], 0, m_mvps.size());
+
+                for (size_t i = 0; i < m_mvps.size(); ++i)
+                    writeCommandBuffer(cmd, tracker, m_mvps[i], m_textureIndices[i], m_frameStats.commands);
+                break;
+
+            case LaunchOptions::RenderMode::Instanced:
+                writeInstancedCommandBuffer(cmd, tracker, viewProjection);
+                break;
+
+            case LaunchOptions::RenderMode::Indirect:
+                writeIndirectCommandBuffer(cmd, tracker, frame, viewProjection);
+                break;
+        }
+
+        m_profiler.writeEnd(cmd, drawScope);
+    }
+
+    if(Render::end(cmd, m_mainView, imageIndex, &m_profiler, &m_frameStats.commands) != VK_SUCCESS)
+        return false;
+
+    m_pipelineStatistics.end(cmd);
+
+    return Render::endFrame(cmd) == VK_SUCCESS;
+}
+
+
+//  Stands in for a frame that failed to record, the image is cleared and moved to its final layout so it can still be presented
+bool Application::writeClearedFrame(VkCommandBuffer cmd, uint32_t imageIndex) noexcept
+{
+    return vkResetCommandBuffer(cmd, /*VkCommandBufferResetFlagBits*/ 0) == VK_SUCCESS
+        && Render::beginFrame(cmd) == VK_SUCCESS
+        && Render::begin(cmd, m_mainView, imageIndex) == VK_SUCCESS
+        && Render::end(cmd, m_mainView, imageIndex) == VK_SUCCESS
+        && Render::endFrame(cmd) == VK_SUCCESS;
 }
 
 
 void Application::drawFrame() noexcept
 {
+    TRACE_SCOPE("drawFrame");
+
     auto frame  = m_sync.currentFrame;
     auto device = m_context.getDevice();
     auto queue  = m_context.getQueue();
 
-    vkWaitForFences(device, 1, &m_sync.inFlightFences[frame], VK_TRUE, UINT64_MAX);
+    auto phaseStart = FrameBenchmark::Clock::now();
+
+    {
+        TRACE_SCOPE("waitForFrame");
+        m_sync.waitForFrame(frame);
+    }
+
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Acquire, phaseStart);
+
+    phaseStart = FrameBenchmark::Clock::now();
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, m_mainView.getSwapchain(), UINT64_MAX, m_sync.imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+    // everything that does not need the image is recorded before the acquire, a failure up to there leaves the swapchain untouched
+    auto commandBuffer = m_commandPool.commandBuffers[frame];
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    if(vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0) != VK_SUCCESS || Render::beginFrame(commandBuffer) != VK_SUCCESS)
     {
-        recreateSwapChain();
+        printf("failed to begin recording command buffer!\n");
         return;
     }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+
+    m_profiler.beginFrame(device, commandBuffer, frame);
+
+    if(m_benchmark)
+        for (const auto& scope : m_profiler.getResults())
+            m_benchmark->addGpuTime(scope.name, scope.milliseconds);
+
+    m_frameStats.commands = {};
+    m_activePipeline = &selectPipeline();
+    m_activeDynamicState.polygonMode = m_wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
+
+    const mat4s viewProjection = computeViewProjection();
+    const uint32_t drawScope = m_profiler.reserveScope("draw");
+
+    if(m_recordPool && !writeSecondaryCommandBuffers(frame, viewProjection, drawScope))
     {
-        printf("failed to acquire swap chain image!");
+        printf("failed to record secondary command buffers!\n");
+        return;
     }
 
-    vkResetFences(device, 1, &m_sync.inFlightFences[frame]);
+    // finished uploads are acquired here, before their slots are redirected and the table of this frame is bound
+    m_uploads.isComplete(); // frees the startup staging memory once it has been consumed
+    m_context.getAllocator().updateBudget();
+    m_streamer.touch(m_streamedSlot); // every cube is drawn each frame, so the streamed texture is always in use
+    m_frameStats.commands.barriers += m_streamer.update(commandBuffer);
+    m_textureTable.flush(device, frame);
+    m_frameStats.pipelineValid = m_pipelineStatistics.beginFrame(device, commandBuffer, frame, m_frameStats.pipeline);
 
-    auto commandBuffer = m_commandPool.commandBuffers[frame];
-    auto descriptorSet = m_descriptorSets[frame];
+    // the scene pass query spans culling as well, so compute invocations are counted
+    m_pipelineStatistics.begin(commandBuffer);
 
-    vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0);
+    if(m_options.renderMode == LaunchOptions::RenderMode::Indirect)
+    {
+        const uint32_t cullScope = m_profiler.beginScope(commandBuffer, "cull");
+        writeCullingCommands(commandBuffer, frame, viewProjection);
+        m_profiler.endScope(commandBuffer, cullScope);
+    }
 
-    if(Render::begin(commandBuffer, m_mainView, imageIndex) != VK_SUCCESS)
-        return;
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Record, phaseStart);
+
+    phaseStart = FrameBenchmark::Clock::now();
+
+    const bool offscreen = m_mainView.isOffscreen();
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getHandle());
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getLayout(), 0, 1, &descriptorSet, 0, nullptr);
+    // offscreen targets are owned per frame in flight, the timeline wait above already guards their reuse
+    uint32_t imageIndex = frame;
+    VkResult result = VK_SUCCESS;
 
-    for (size_t i = 0; i < cubePositions.size(); ++i)
+    if (!offscreen)
     {
-        const float angle = 20.f * i;
-        updateUniformBuffer(cubePositions[i], angle);
-        writeCommandBuffer(commandBuffer, imageIndex, descriptorSet);
+        {
+            TRACE_SCOPE("vkAcquireNextImageKHR");
+            result = vkAcquireNextImageKHR(device, m_mainView.getSwapchain(), UINT64_MAX, m_sync.imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+        }
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            recreateSwapChain();
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        {
+            printf("failed to acquire swap chain image!");
+            return;
+        }
     }
 
-    if(Render::end(commandBuffer, m_mainView, imageIndex) != VK_SUCCESS)
-        return;
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Acquire, phaseStart);
+
+    phaseStart = FrameBenchmark::Clock::now();
+
+    // from here on the frame is always submitted and presented: it has to wait on the acquire semaphore and signal its timeline value,
+    // a frame that failed to record shows a cleared image, and only its semaphores are submitted if not even that could be recorded
+    const bool recorded = writeScenePass(commandBuffer, frame, imageIndex, viewProjection, drawScope);
+    const bool cleared  = !recorded && writeClearedFrame(commandBuffer, imageIndex);
+
+    if (!recorded)
+        printf("failed to record command buffer!\n");
+
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Record, phaseStart);
+
+    phaseStart = FrameBenchmark::Clock::now();
+
+    // the frame signals the next value of the graphics timeline, the binary semaphore after it is only there for present
+    const uint64_t signalValue = m_sync.graphicsTimeline.peek();
+    const std::array<VkSemaphore, 2> signalSemaphores = { m_sync.graphicsTimeline.getHandle(), m_sync.renderFinishedSemaphores[frame] };
+    const std::array<uint64_t, 2> signalValues = { signalValue, 0 };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = offscreen ? 1 : 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues.data();
 
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = offscreen ? 0 : 1;
     submitInfo.pWaitSemaphores = m_sync.imageAvailableSemaphores.data() + frame;
     submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.commandBufferCount = 1;
+    submitInfo.commandBufferCount = (recorded || cleared) ? 1 : 0;
     submitInfo.pCommandBuffers = &m_commandPool.commandBuffers[frame];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &m_sync.renderFinishedSemaphores[frame];
+    submitInfo.signalSemaphoreCount = offscreen ? 1 : 2;
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+    {
+        TRACE_SCOPE("vkQueueSubmit");
+
+        result = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+
+        if (result != VK_SUCCESS && submitInfo.commandBufferCount > 0)
+        {
+            printf("failed to submit draw command buffer!");
+
+            // the semaphores alone, so the acquired image is still waited on and the frame's values are still signalled
+            submitInfo.commandBufferCount = 0;
+            result = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+        }
+
+        if (result == VK_SUCCESS)
+        {
+            m_sync.graphicsTimeline.commit(signalValue);
+            m_sync.frameValues[frame] = signalValue;
+
+            // streamed textures are only acquired when the scene pass itself reached the queue
+            if (recorded && submitInfo.commandBufferCount > 0)
+                m_streamer.onFrameSubmitted();
+        }
+
+        ++m_frameStats.commands.submits;
+    }
 
-    if (auto result = vkQueueSubmit(queue, 1, &submitInfo, m_sync.inFlightFences[frame]); result != VK_SUCCESS)
+    if(m_benchmark)
+        m_benchmark->addFrameStats(m_frameStats);
+
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Submit, phaseStart);
+
+    m_sync.currentFrame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+    // nothing will signal the present semaphore, the device is most likely lost
+    if (result != VK_SUCCESS)
     {
-        printf("failed to submit draw command buffer!");
+        printf("failed to submit frame!\n");
+        return;
     }
 
+    m_lastImageIndex = imageIndex;
+
+    if (offscreen)
+        return;
+
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -445,7 +1363,15 @@ void Application::drawFrame() noexcept
     presentInfo.pSwapchains        = &m_mainView.getSwapchain();
     presentInfo.pImageIndices      = &imageIndex;
 
-    result = vkQueuePresentKHR(queue, &presentInfo);
+    phaseStart = FrameBenchmark::Clock::now();
+
+    {
+        TRACE_SCOPE("vkQueuePresentKHR");
+        result = vkQueuePresentKHR(queue, &presentInfo);
+    }
+
+    if(m_benchmark)
+        m_benchmark->addPhase(FrameBenchmark::Phase::Present, phaseStart);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
     {
@@ -456,6 +1382,4 @@ void Application::drawFrame() noexcept
     {
         printf("failed to present swap chain image!");
     }
-
-    m_sync.currentFrame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
\ No newline at end of file
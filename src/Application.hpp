@@ -1,52 +1,120 @@
 #ifndef APPLICATION_HPP
 #define APPLICATION_HPP
 
+#include <vector>
+
 #include <cglm/struct/vec3.h>
 #include <cglm/call/mat4.h>
 
+#include "LaunchOptions.hpp"
+#include "utils/AssetArchive.hpp"
+#include "utils/ThreadPool.hpp"
+#include "scene/TransformArray.hpp"
+#include "benchmark/FrameBenchmark.hpp"
 #include "vulkan_api/utils/Defines.hpp"
 #include "vulkan_api/presentation/MainView.hpp"
 #include "vulkan_api/pipeline/GraphicsPipeline.hpp"
+#include "vulkan_api/pipeline/ComputePipeline.hpp"
+#include "vulkan_api/pipeline/DynamicState.hpp"
+#include "vulkan_api/pipeline/PipelineCompiler.hpp"
 #include "vulkan_api/pipeline/descriptors/DescriptorPool.hpp"
 #include "vulkan_api/command_pool/CommandBufferPool.hpp"
+#include "vulkan_api/command_pool/ThreadCommandPools.hpp"
 #include "vulkan_api/sync/SyncManager.hpp"
+#include "vulkan_api/profiler/GpuProfiler.hpp"
+#include "vulkan_api/profiler/PipelineStatisticsQuery.hpp"
 #include "vulkan_api/texture/Texture2D.hpp"
+#include "vulkan_api/texture/TextureTable.hpp"
+#include "vulkan_api/texture/TextureStreamer.hpp"
+#include "vulkan_api/resources/UploadBatch.hpp"
 #include "vulkan_api/resources/VkResourceHolder.hpp"
 
 class Application
 {
 public:
-    int run() noexcept;
+    int run(const LaunchOptions& options) noexcept;
 
 private:
     void initWindow() noexcept;
     bool initVulkan() noexcept;
+    bool initCulling() noexcept;
     void mainLoop() noexcept;
     void cleanup() noexcept;
     void recreateSwapChain() noexcept;
-    void updateUniformBuffer(vec3s pos, float angle) noexcept;
+    bool dumpFrame(const char* path) noexcept;
+    bool writeBenchmarkReport() const noexcept;
+    mat4s computeViewProjection() const noexcept;
+    VkResult loadShader(class ShaderStage& shader, VkShaderStageFlagBits stage, const char* path) const noexcept;
+    GraphicsPipeline::State makePipelineState(VkPolygonMode mode) const noexcept;
+    void toggleWireframe() noexcept;
+    const GraphicsPipeline& selectPipeline() const noexcept;
+    void writeDynamicState(VkCommandBuffer commandBuffer, DynamicState::Tracker& tracker, CommandCounters& counters) noexcept;
 
-    void writeCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkDescriptorSet descriptorSet) noexcept;
+    void writeCommandBuffer(VkCommandBuffer commandBuffer, DynamicState::Tracker& tracker, const mat4s& mvp, uint32_t textureIndex, CommandCounters& counters) noexcept;
+    bool writeSecondaryCommandBuffers(uint32_t frame, const mat4s& viewProjection, uint32_t drawScope) noexcept;
+    void writeInstancedCommandBuffer(VkCommandBuffer commandBuffer, DynamicState::Tracker& tracker, const mat4s& viewProjection) noexcept;
+    void writeCullingCommands(VkCommandBuffer commandBuffer, uint32_t frame, const mat4s& viewProjection) noexcept;
+    void writeIndirectCommandBuffer(VkCommandBuffer commandBuffer, DynamicState::Tracker& tracker, uint32_t frame, const mat4s& viewProjection) noexcept;
+    bool writeScenePass(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t imageIndex, const mat4s& viewProjection, uint32_t drawScope) noexcept;
+    bool writeClearedFrame(VkCommandBuffer commandBuffer, uint32_t imageIndex) noexcept;
     void drawFrame() noexcept;
 
-    struct GLFWwindow* window;
+    struct GLFWwindow* window = nullptr;
+
+    LaunchOptions      m_options;
+    std::unique_ptr<FrameBenchmark> m_benchmark;
+    TransformArray     m_transforms;
+    std::vector<mat4s> m_mvps;
+    AssetArchive       m_assets; // res/assets.pak, loose files are read when it is missing
 
     VulkanContext m_context;
     MainView  m_mainView;
-    GraphicsPipeline  m_pipeline;
+    std::shared_ptr<const GraphicsPipeline> m_pipeline; // filled, also stands in for variants that are still compiling
+    std::array<ShaderStage, 2> m_shaders; // kept for the variants built at runtime
+    PipelineCompiler           m_pipelineCompiler;
+    PipelineCompiler::Handle   m_wireframePipeline;
+    const GraphicsPipeline*    m_activePipeline = nullptr; // picked once per frame, read by the recording threads
+    bool                       m_wireframe = false;
+    DynamicState               m_dynamicState;       // enabled by --dynamic-state on capable devices
+    DynamicState::Values       m_activeDynamicState; // picked with the pipeline, applied before every draw
     std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_descriptorSets {};
     std::unique_ptr<DescriptorPool> m_descriptorPool;
+
+//  GPU driven culling
+    ComputePipeline m_cullPipeline;
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_cullDescriptorSets {};
+    std::unique_ptr<DescriptorPool> m_cullDescriptorPool;
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_drawCommands;
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_drawCounts;
     
     CommandBufferPool m_commandPool;
+
+//  Parallel recording of the legacy draw list
+    ThreadCommandPools          m_threadCommandPools;
+    std::unique_ptr<ThreadPool> m_recordPool;
     SyncManager       m_sync;
+    GpuProfiler       m_profiler;
+    PipelineStatisticsQuery m_pipelineStatistics;
+    FrameStats              m_frameStats;
+    std::vector<CommandCounters> m_threadCounters; // one per recording thread, merged into m_frameStats
+    std::vector<VkResult>        m_threadResults;  // one per recording thread, VK_SUCCESS once its buffer is recorded and ended
 
-    Texture2D m_texture;
+//  Every cube picks its texture from the table by index
+    std::vector<Texture2D> m_textures;
+    TextureTable           m_textureTable;
+    TextureStreamer        m_streamer;
+    std::vector<uint32_t>  m_textureIndices;
+    uint32_t               m_streamedSlot = TextureTable::INVALID_INDEX;
 
     std::unique_ptr<VkResourceHolder> m_holder;
+    StagingRing m_staging; // shared by every upload
+    UploadBatch m_uploads; // every startup transfer, one submit, polled by the frames until it completes
     Buffer m_vertices;
     Buffer m_indices;
+    Buffer m_instances;
+    Buffer m_materials; // per-instance texture indices of the instanced modes
 
-    mat4s m_mvp;
+    uint32_t m_lastImageIndex = 0;
 
     bool framebufferResized = false;
     int32_t m_width = 0;
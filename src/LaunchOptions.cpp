@@ -0,0 +1,269 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "LaunchOptions.hpp"
+
+
+namespace
+{
+    bool parse_uint(const char* text, uint32_t& value) noexcept
+    {
+        char* end = nullptr;
+        const unsigned long result = std::strtoul(text, &end, 10);
+
+        if(end == text || *end != '\0' || result > UINT32_MAX)
+            return false;
+
+        value = static_cast<uint32_t>(result);
+
+        return true;
+    }
+
+
+    bool parse_seconds(const char* text, double& value) noexcept
+    {
+        char* end = nullptr;
+        const double result = std::strtod(text, &end);
+
+        if(end == text || *end != '\0' || !(result > 0.0))
+            return false;
+
+        value = result;
+
+        return true;
+    }
+}
+
+
+bool LaunchOptions::parse(int argc, char** argv) noexcept
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+        else if (arg == "--mode" && value)
+        {
+            const std::string_view mode = value;
+
+            if (mode == "legacy")
+                renderMode = RenderMode::Legacy;
+            else if (mode == "instanced")
+                renderMode = RenderMode::Instanced;
+            else if (mode == "indirect")
+                renderMode = RenderMode::Indirect;
+            else
+            {
+                printf("unknown render mode: %s\n", value);
+                return false;
+            }
+
+            ++i;
+        }
+        else if (arg == "--cubes" && value)
+        {
+            if (!parse_uint(value, cubeCount) || cubeCount == 0)
+            {
+                printf("invalid cube count: %s\n", value);
+                return false;
+            }
+
+            ++i;
+        }
+        else if (arg == "--threads" && value)
+        {
+            if (!parse_uint(value, recordThreads) || recordThreads == 0)
+            {
+                printf("invalid thread count: %s\n", value);
+                return false;
+            }
+
+            ++i;
+        }
+        else if (arg == "--no-mips")
+        {
+            mipmaps = false;
+        }
+        else if (arg == "--staged-upload")
+        {
+            stagedUpload = true;
+        }
+        else if (arg == "--wireframe")
+        {
+            wireframe = true;
+        }
+        else if (arg == "--dynamic-state")
+        {
+            dynamicState = true;
+        }
+        else if (arg == "--bench-transforms")
+        {
+            benchTransforms = true;
+        }
+        else if (arg == "--headless")
+        {
+            headless = true;
+        }
+        else if (arg == "--headless-surface")
+        {
+            headless = true;
+            headlessSurface = true;
+        }
+        else if (arg == "--frames" && value)
+        {
+            if (!parse_uint(value, frameCount) || frameCount == 0)
+            {
+                printf("invalid frame count: %s\n", value);
+                return false;
+            }
+
+            ++i;
+        }
+        else if (arg == "--dump" && value)
+        {
+            dumpPath = value;
+            ++i;
+        }
+        else if (arg == "--bench")
+        {
+            benchmark = true;
+        }
+        else if (arg == "--bench-warmup" && value)
+        {
+            if (!parse_uint(value, benchmarkSettings.warmupFrames))
+            {
+                printf("invalid warm-up frame count: %s\n", value);
+                return false;
+            }
+
+            benchmark = true;
+            ++i;
+        }
+        else if (arg == "--bench-frames" && value)
+        {
+            if (!parse_uint(value, benchmarkSettings.frameCount) || benchmarkSettings.frameCount == 0)
+            {
+                printf("invalid benchmark frame count: %s\n", value);
+                return false;
+            }
+
+            benchmark = true;
+            ++i;
+        }
+        else if (arg == "--bench-duration" && value)
+        {
+            if (!parse_seconds(value, benchmarkSettings.durationSeconds))
+            {
+                printf("invalid benchmark duration: %s\n", value);
+                return false;
+            }
+
+            benchmark = true;
+            ++i;
+        }
+        else if (arg == "--bench-format" && value)
+        {
+            const std::string_view format = value;
+
+            if (format == "json")
+                benchmarkSettings.format = FrameBenchmark::Format::Json;
+            else if (format == "csv")
+                benchmarkSettings.format = FrameBenchmark::Format::Csv;
+            else
+            {
+                printf("unknown benchmark format: %s\n", value);
+                return false;
+            }
+
+            benchmark = true;
+            ++i;
+        }
+        else if (arg == "--bench-output" && value)
+        {
+            benchmarkOutput = value;
+            benchmark = true;
+            ++i;
+        }
+        else if (arg == "--trace" && value)
+        {
+#ifdef ENABLE_TRACING
+            tracePath = value;
+            ++i;
+#else
+            printf("--trace requires a build configured with -DVULKAN_CUBES_ENABLE_TRACING=ON\n");
+            return false;
+#endif
+        }
+        else
+        {
+            printf("unknown or incomplete option: %s\n", argv[i]);
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (dumpPath && (!headless || headlessSurface))
+    {
+        printf("--dump requires --headless without --headless-surface, swapchain images can not be read back after presentation\n");
+        return false;
+    }
+
+    if (benchmark && frameCount != 0)
+        printf("--frames is ignored while benchmarking, use --bench-frames or --bench-duration\n");
+
+    if (headless && frameCount == 0)
+        frameCount = 100;
+
+    if (recordThreads > 1 && renderMode != RenderMode::Legacy)
+        printf("--threads only splits the legacy draw list, it has no effect in this mode\n");
+
+    return true;
+}
+
+
+const char* LaunchOptions::getRenderModeName(RenderMode mode) noexcept
+{
+    switch (mode)
+    {
+        case RenderMode::Legacy:    return "legacy";
+        case RenderMode::Instanced: return "instanced";
+        case RenderMode::Indirect:  return "indirect";
+    }
+
+    return "unknown";
+}
+
+
+void LaunchOptions::printUsage(const char* program) noexcept
+{
+    printf("usage: %s [options]\n", program);
+    printf("  --mode legacy|instanced|indirect\n");
+    printf("                           legacy: one draw per cube, instanced: one draw for all cubes,\n");
+    printf("                           indirect: GPU frustum culling and vkCmdDrawIndexedIndirectCount\n");
+    printf("  --cubes N                number of cubes in the scene (default 10)\n");
+    printf("  --threads N              record the legacy draw list on N threads into secondary command buffers\n");
+    printf("  --no-mips                load textures without mip chains, for A/B runs against the default\n");
+    printf("  --staged-upload          upload buffers through a staging copy even on UMA or resizable BAR devices\n");
+    printf("  --wireframe              draw wireframe once its pipeline has compiled in the background, F toggles it\n");
+    printf("  --dynamic-state          set polygon mode, culling, depth and blending with extended dynamic state,\n");
+    printf("                           every variant shares one pipeline (VK_EXT_extended_dynamic_state3)\n");
+    printf("  --headless               render into offscreen images without a window\n");
+    printf("  --headless-surface       like --headless, but present to a VK_EXT_headless_surface swapchain when available\n");
+    printf("  --frames N               stop after N frames (headless default 100)\n");
+    printf("  --dump FILE.png          write the last headless frame to disk, not with --headless-surface\n");
+    printf("  --bench                  measure frame times and print a report on exit, the frame limiter is disabled\n");
+    printf("  --bench-warmup N         frames to skip before measuring (default 60)\n");
+    printf("  --bench-frames N         frames to measure (default 1000)\n");
+    printf("  --bench-duration SECONDS measure for a fixed time instead of a frame count\n");
+    printf("  --bench-format json|csv  report format (default json)\n");
+    printf("  --bench-output FILE      write the report to FILE instead of stdout\n");
+    printf("  --trace FILE.json        write a Chrome trace of the CPU hot path on exit (tracing builds only)\n");
+    printf("  --bench-transforms       run the transform kernel microbenchmark and exit\n");
+    printf("  --help                   show this message\n");
+}
\ No newline at end of file
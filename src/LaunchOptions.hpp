@@ -0,0 +1,46 @@
+#ifndef LAUNCH_OPTIONS_HPP
+#define LAUNCH_OPTIONS_HPP
+
+#include <cstdint>
+
+#include "benchmark/FrameBenchmark.hpp"
+
+
+struct LaunchOptions
+{
+    enum class RenderMode
+    {
+        Legacy,    // one push constant + vkCmdDrawIndexed per cube
+        Instanced, // one vkCmdDrawIndexed for all cubes, transforms in a storage buffer
+        Indirect   // compute shader frustum culling + vkCmdDrawIndexedIndirectCount
+    };
+
+    bool parse(int argc, char** argv) noexcept;
+    static void printUsage(const char* program) noexcept;
+    static const char* getRenderModeName(RenderMode mode) noexcept;
+
+    RenderMode  renderMode      = RenderMode::Legacy;
+    uint32_t    cubeCount       = 10;
+    uint32_t    recordThreads   = 1;
+    bool        benchTransforms = false;
+    bool        mipmaps         = true;
+    bool        stagedUpload    = false; // copy buffers through staging memory even when device-local memory is host visible
+    bool        wireframe       = false; // start with the wireframe pipeline, F toggles it in windowed runs
+    bool        dynamicState    = false; // polygon mode, culling, depth and blend switches set in the command buffer, one pipeline for all variants
+
+//  Headless runs render a fixed number of frames without a window and exit
+    bool        headless        = false;
+    bool        headlessSurface = false;
+    uint32_t    frameCount      = 0; // 0 - until the window is closed, headless runs default to 100
+    const char* dumpPath        = nullptr;
+
+//  Frame time benchmark, runs unthrottled and exits once the configured frames or duration are measured
+    bool                      benchmark       = false;
+    FrameBenchmark::Settings  benchmarkSettings;
+    const char*               benchmarkOutput = nullptr;
+
+//  Chrome trace JSON, only available in builds with VULKAN_CUBES_ENABLE_TRACING
+    const char*               tracePath       = nullptr;
+};
+
+#endif // !LAUNCH_OPTIONS_HPP
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "benchmark/FrameBenchmark.hpp"
+
+
+namespace
+{
+//  duration runs do not know their frame count up front, the ring keeps the most recent samples
+    constexpr size_t DURATION_RING_CAPACITY = 1 << 17;
+
+    constexpr std::array<const char*, 5> COLUMN_NAMES = { "frame", "acquire", "record", "submit", "present" };
+
+    constexpr size_t COMMAND_STAT_COUNT = 9;
+
+    constexpr std::array<const char*, 15> STAT_NAMES = 
+    {
+        "draws", "dispatches", "pipelineBinds", "descriptorSetBinds", "bufferBinds", "pushConstants", "dynamicStates", "barriers", "submits",
+        "inputVertices", "inputPrimitives", "vertexInvocations", "clippingPrimitives", "fragmentInvocations", "computeInvocations"
+    };
+
+
+//  quotes, backslashes and control characters, e.g. in a device name reported by the driver
+    std::string escape_json(const char* text) noexcept
+    {
+        std::string escaped;
+
+        for (const char* c = text; *c; ++c)
+        {
+            const unsigned char value = static_cast<unsigned char>(*c);
+
+            if (value == '"' || value == '\\')
+            {
+                escaped += '\\';
+                escaped += *c;
+            }
+            else if (value < 0x20)
+            {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", value);
+                escaped += code;
+            }
+            else
+                escaped += *c;
+        }
+
+        return escaped;
+    }
+
+
+    double percentile(const std::vector<float>& sorted, size_t count, double p) noexcept
+    {
+        // nearest rank
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * count));
+
+        return sorted[std::clamp<size_t>(rank, 1, count) - 1];
+    }
+}
+
+
+FrameBenchmark::FrameBenchmark(const Settings& settings) noexcept:
+    m_settings(settings),
+    m_current({}),
+    m_framesSeen(0),
+    m_framesRecorded(0)
+{
+    const size_t capacity = (m_settings.durationSeconds > 0.0) ? DURATION_RING_CAPACITY : std::max<size_t>(m_settings.frameCount, 1);
+
+    m_ring.resize(capacity);
+    m_scratch.resize(capacity);
+
+    m_statSeries.reserve(STAT_NAMES.size());
+
+    for (const char* name : STAT_NAMES)
+        m_statSeries.push_back({ name, std::vector<float>(capacity), 0 });
+}
+
+
+void FrameBenchmark::beginFrame() noexcept
+{
+    m_current.fill(0.f);
+    m_frameStart = Clock::now();
+
+    if (m_framesSeen == m_settings.warmupFrames)
+        m_measureStart = m_frameStart;
+}
+
+
+void FrameBenchmark::endFrame() noexcept
+{
+    const std::chrono::duration<float, std::milli> elapsed = Clock::now() - m_frameStart;
+    m_current[0] = elapsed.count();
+
+    if (m_framesSeen++ < m_settings.warmupFrames)
+        return;
+
+    m_ring[m_framesRecorded % m_ring.size()] = m_current;
+    ++m_framesRecorded;
+}
+
+
+void FrameBenchmark::addPhase(Phase phase, TimePoint start) noexcept
+{
+    const std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+    m_current[1 + static_cast<size_t>(phase)] += elapsed.count();
+}
+
+
+void FrameBenchmark::addGpuTime(const char* name, double milliseconds) noexcept
+{
+    if (m_framesSeen < m_settings.warmupFrames)
+        return;
+
+    auto series = std::find_if(m_gpuSeries.begin(), m_gpuSeries.end(), [name](const Series& s) { return strcmp(s.name, name) == 0; });
+
+    if (series == m_gpuSeries.end())
+    {
+        m_gpuSeries.push_back({ name, std::vector<float>(m_ring.size()), 0 });
+        series = m_gpuSeries.end() - 1;
+    }
+
+    series->push(static_cast<float>(milliseconds));
+}
+
+
+void FrameBenchmark::addFrameStats(const FrameStats& stats) noexcept
+{
+    if (m_framesSeen < m_settings.warmupFrames)
+        return;
+
+    const auto& c = stats.commands;
+    const std::array<uint32_t, COMMAND_STAT_COUNT> commands = { c.draws, c.dispatches, c.pipelineBinds, c.descriptorSetBinds, c.bufferBinds, c.pushConstants, c.dynamicStates, c.barriers, c.submits };
+
+    for (size_t i = 0; i < commands.size(); ++i)
+        m_statSeries[i].push(static_cast<float>(commands[i]));
+
+    if (stats.pipelineValid)
+    {
+        const auto& p = stats.pipeline;
+        const std::array<uint64_t, STAT_NAMES.size() - COMMAND_STAT_COUNT> pipeline = { p.inputVertices, p.inputPrimitives, p.vertexInvocations, p.clippingPrimitives, p.fragmentInvocations, p.computeInvocations };
+
+        for (size_t i = 0; i < pipeline.size(); ++i)
+            m_statSeries[COMMAND_STAT_COUNT + i].push(static_cast<float>(pipeline[i]));
+    }
+}
+
+
+bool FrameBenchmark::isFinished() const noexcept
+{
+    if (m_framesSeen <= m_settings.warmupFrames)
+        return false;
+
+    if (m_settings.durationSeconds > 0.0)
+    {
+        const std::chrono::duration<double> elapsed = Clock::now() - m_measureStart;
+
+        return elapsed.count() >= m_settings.durationSeconds;
+    }
+
+    return m_framesRecorded >= m_settings.frameCount;
+}
+
+
+bool FrameBenchmark::write(const RunInfo& info, const char* path) const noexcept
+{
+    FILE* file = path ? fopen(path, "w") : stdout;
+
+    if (!file)
+    {
+        printf("failed to open %s\n", path);
+        return false;
+    }
+
+    const size_t sampleCount = getSampleCount();
+
+    if (m_settings.format == Format::Json)
+    {
+        fprintf(file, "{\n");
+        fprintf(file, "  \"mode\": \"%s\",\n", info.renderMode);
+        fprintf(file, "  \"device\": \"%s\",\n", escape_json(info.device).c_str());
+        fprintf(file, "  \"cubes\": %u,\n", info.cubeCount);
+        fprintf(file, "  \"threads\": %u,\n", info.recordThreads);
+        fprintf(file, "  \"headless\": %s,\n", info.headless ? "true" : "false");
+        fprintf(file, "  \"mipmaps\": %s,\n", info.mipmaps ? "true" : "false");
+        fprintf(file, "  \"upload\": \"%s\",\n", info.upload);
+        fprintf(file, "  \"warmupFrames\": %u,\n", m_settings.warmupFrames);
+        fprintf(file, "  \"framesRecorded\": %llu,\n", static_cast<unsigned long long>(m_framesRecorded));
+        fprintf(file, "  \"samples\": %zu,\n", sampleCount);
+        fprintf(file, "  \"cpuMs\": {\n");
+
+        for (size_t column = 0; column < COLUMN_COUNT; ++column)
+        {
+            const Summary s = summarize(m_ring, column, sampleCount);
+
+            fprintf(file, "    \"%s\": { \"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+                COLUMN_NAMES[column], s.min, s.mean, s.p50, s.p95, s.p99, s.max, (column + 1 < COLUMN_COUNT) ? "," : "");
+        }
+
+        fprintf(file, "  },\n");
+
+        writeSeries(file, info, "gpuMs", "ms", m_gpuSeries, false);
+        writeSeries(file, info, "perFrame", "count", m_statSeries, true);
+
+        fprintf(file, "}\n");
+    }
+    else
+    {// one row per metric with the run description repeated, so files from several runs can simply be concatenated
+        fprintf(file, "mode,device,cubes,threads,headless,mipmaps,upload,samples,metric,unit,min,mean,p50,p95,p99,max\n");
+
+        for (size_t column = 0; column < COLUMN_COUNT; ++column)
+        {
+            const Summary s = summarize(m_ring, column, sampleCount);
+
+            fprintf(file, "%s,\"%s\",%u,%u,%d,%d,%s,%zu,%s,ms,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                info.renderMode, info.device, info.cubeCount, info.recordThreads, info.headless ? 1 : 0, info.mipmaps ? 1 : 0, info.upload, sampleCount,
+                COLUMN_NAMES[column], s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+        }
+
+        writeSeries(file, info, "gpu", "ms", m_gpuSeries, false);
+        writeSeries(file, info, "stat", "count", m_statSeries, true);
+    }
+
+    if (path)
+        fclose(file);
+
+    return true;
+}
+
+
+void FrameBenchmark::writeSeries(FILE* file, const RunInfo& info, const char* section, const char* unit, const std::vector<Series>& series, bool last) const noexcept
+{
+    if (m_settings.format == Format::Json)
+        fprintf(file, "  \"%s\": {\n", section);
+
+    bool first = true;
+
+    for (const auto& it : series)
+    {
+        if (it.count == 0)
+            continue; // e.g. pipeline statistics on devices without the query
+
+        const size_t count = it.size();
+        const Summary s = summarize(it.ring, count);
+
+        if (m_settings.format == Format::Json)
+        {
+            fprintf(file, "%s    \"%s\": { \"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+                first ? "" : ",\n", it.name, s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+        }
+        else
+        {
+            fprintf(file, "%s,\"%s\",%u,%u,%d,%d,%s,%zu,%s:%s,%s,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                info.renderMode, info.device, info.cubeCount, info.recordThreads, info.headless ? 1 : 0, info.mipmaps ? 1 : 0, info.upload, count,
+                section, it.name, unit, s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+        }
+
+        first = false;
+    }
+
+    if (m_settings.format == Format::Json)
+        fprintf(file, "%s  }%s\n", first ? "" : "\n", last ? "" : ",");
+}
+
+
+FrameBenchmark::Summary FrameBenchmark::summarize(const std::vector<Sample>& samples, size_t column, size_t count) const noexcept
+{
+    if (count == 0)
+        return {};
+
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_scratch[i] = samples[i][column];
+        sum += m_scratch[i];
+    }
+
+    return summarizeScratch(count, sum);
+}
+
+
+FrameBenchmark::Summary FrameBenchmark::summarize(const std::vector<float>& values, size_t count) const noexcept
+{
+    if (count == 0)
+        return {};
+
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_scratch[i] = values[i];
+        sum += m_scratch[i];
+    }
+
+    return summarizeScratch(count, sum);
+}
+
+
+FrameBenchmark::Summary FrameBenchmark::summarizeScratch(size_t count, double sum) const noexcept
+{
+    std::sort(m_scratch.begin(), m_scratch.begin() + count);
+
+    return 
+    {
+        .min  = m_scratch[0],
+        .mean = sum / count,
+        .p50  = percentile(m_scratch, count, 50.0),
+        .p95  = percentile(m_scratch, count, 95.0),
+        .p99  = percentile(m_scratch, count, 99.0),
+        .max  = m_scratch[count - 1]
+    };
+}
+
+
+void FrameBenchmark::Series::push(float value) noexcept
+{
+    ring[count % ring.size()] = value;
+    ++count;
+}
+
+
+size_t FrameBenchmark::Series::size() const noexcept
+{
+    return static_cast<size_t>(std::min<uint64_t>(count, ring.size()));
+}
+
+
+size_t FrameBenchmark::getSampleCount() const noexcept
+{
+    return static_cast<size_t>(std::min<uint64_t>(m_framesRecorded, m_ring.size()));
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef FRAME_BENCHMARK_HPP
+#define FRAME_BENCHMARK_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <array>
+#include <vector>
+
+#include "vulkan_api/profiler/FrameStats.hpp"
+
+
+// Frame time recorder for benchmark runs.
+// Samples go into a ring allocated up front, nothing is allocated while frames are being measured.
+class FrameBenchmark
+{
+public:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    enum class Phase : uint32_t
+    {
+        Acquire, // frame timeline wait + vkAcquireNextImageKHR
+        Record,  // command buffer reset, recording and end
+        Submit,  // vkQueueSubmit
+        Present, // vkQueuePresentKHR
+        Count
+    };
+
+    enum class Format
+    {
+        Json,
+        Csv
+    };
+
+    struct Settings
+    {
+        uint32_t warmupFrames    = 60;
+        uint32_t frameCount      = 1000; // ignored when durationSeconds is set
+        double   durationSeconds = 0.0;
+        Format   format          = Format::Json;
+    };
+
+//  Describes the run in the report, so results of different builds and modes can be told apart
+    struct RunInfo
+    {
+        const char* renderMode;
+        const char* device;
+        uint32_t    cubeCount;
+        uint32_t    recordThreads;
+        bool        headless;
+        bool        mipmaps;
+        const char* upload; // "direct" or "staged", how the vertex, index and instance buffers were filled
+    };
+
+    explicit FrameBenchmark(const Settings& settings) noexcept;
+
+    void beginFrame() noexcept;
+    void endFrame() noexcept;
+    void addPhase(Phase phase, TimePoint start) noexcept; // adds the time elapsed since start to the current frame
+
+//  GPU scope timings arrive a few frames late, they are collected per name while measuring.
+//  name must be a string with static storage, a new name allocates its ring once.
+    void addGpuTime(const char* name, double milliseconds) noexcept;
+    void addFrameStats(const FrameStats& stats) noexcept;
+
+    bool isFinished() const noexcept;
+
+//  path == nullptr writes to stdout
+    bool write(const RunInfo& info, const char* path) const noexcept;
+
+private:
+//  column 0 is the whole frame, followed by one column per Phase
+    static constexpr size_t COLUMN_COUNT = 1 + static_cast<size_t>(Phase::Count);
+
+    using Sample = std::array<float, COLUMN_COUNT>;
+
+    struct Summary
+    {
+        double min, mean, p50, p95, p99, max;
+    };
+
+//  A named metric with its own ring, used for everything that is not sampled exactly once per frame
+    struct Series
+    {
+        const char*        name;
+        std::vector<float> ring;
+        uint64_t           count;
+
+        void push(float value) noexcept;
+        size_t size() const noexcept;
+    };
+
+//  count is the number of valid entries, a summary of nothing is all zeros
+    Summary summarize(const std::vector<Sample>& samples, size_t column, size_t count) const noexcept;
+    Summary summarize(const std::vector<float>& values, size_t count) const noexcept;
+    Summary summarizeScratch(size_t count, double sum) const noexcept; // over the first count values of m_scratch
+    void writeSeries(FILE* file, const RunInfo& info, const char* section, const char* unit, const std::vector<Series>& series, bool last) const noexcept;
+    size_t getSampleCount() const noexcept;
+
+    Settings m_settings;
+
+    std::vector<Sample>    m_ring;
+    std::vector<Series>    m_gpuSeries;
+    std::vector<Series>    m_statSeries; // CommandCounters followed by PipelineStatistics, see STAT_NAMES
+    mutable std::vector<float> m_scratch; // sorted copy for percentiles, sized with the ring
+
+    Sample    m_current;
+    TimePoint m_frameStart;
+    TimePoint m_measureStart;
+    uint64_t  m_framesSeen;
+    uint64_t  m_framesRecorded;
+};
+
+#endif // !FRAME_BENCHMARK_HPP
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include <cglm/struct/affine-pre.h>
+#include <cglm/struct/cam.h>
+
+#include "scene/TransformArray.hpp"
+#include "benchmark/TransformBenchmark.hpp"
+
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t REPEATS = 5;
+
+    struct Scene
+    {
+        std::vector<vec3s> positions;
+        std::vector<float> angles;
+        TransformArray     transforms;
+    };
+
+
+    Scene makeScene(size_t count) noexcept
+    {
+        Scene scene;
+        scene.positions.reserve(count);
+        scene.angles.reserve(count);
+        scene.transforms.reserve(count);
+
+        const vec3s axis = {1.0f, 0.3f, 0.5f};
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const vec3s position = { float(i % 100) * 2.f, float((i / 100) % 100) * 2.f, -20.f - float(i / 10000) * 2.f };
+            const float angle = 20.f * i;
+
+            scene.positions.push_back(position);
+            scene.angles.push_back(angle);
+            scene.transforms.push(position, glms_quatv(glm_rad(angle), axis), glms_vec3_one());
+        }
+
+        return scene;
+    }
+
+
+//  The path Application used to take for every cube, every frame
+    void writeReference(const Scene& scene, mat4s* dst) noexcept
+    {
+        for (size_t i = 0; i < scene.positions.size(); ++i)
+        {
+            mat4s model = glms_translate(glms_mat4_identity(), scene.positions[i]);
+            model = glms_rotate(model, glm_rad(scene.angles[i]), vec3s {1.0f, 0.3f, 0.5f});
+
+            const mat4s view = glms_lookat(vec3s {0.f, 0.f, 3.f}, vec3s {0.f, 0.f, 0.f}, vec3s {0.f, 1.f, 0.f});
+            mat4s proj = glms_perspective(glm_rad(60.f), 16.f / 9.f, 0.1f, 100.f);
+            proj.col[1].y *= -1.f;
+
+            dst[i] = glms_mat4_mul(glms_mat4_mul(proj, view), model);
+        }
+    }
+
+
+    template<class Func>
+    double bestOf(Func&& func) noexcept
+    {
+        double best = 1e30;
+
+        for (uint32_t i = 0; i < REPEATS; ++i)
+        {
+            const auto start = Clock::now();
+            func();
+            const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+
+        return best;
+    }
+}
+
+
+int runTransformBenchmark() noexcept
+{
+    printf("transform kernel: %s, best of %u runs\n", TransformArray::getKernelName(), REPEATS);
+    printf("%10s %16s %16s %10s %12s\n", "objects", "cglm ns/obj", "batched ns/obj", "speedup", "max error");
+
+    const vec3s eye = {0.f, 0.f, 3.f};
+    const mat4s view = glms_lookat(eye, vec3s {0.f, 0.f, 0.f}, vec3s {0.f, 1.f, 0.f});
+    mat4s proj = glms_perspective(glm_rad(60.f), 16.f / 9.f, 0.1f, 100.f);
+    proj.col[1].y *= -1.f;
+    const mat4s viewProjection = glms_mat4_mul(proj, view);
+
+    for (const size_t count : { size_t(1'000), size_t(100'000), size_t(1'000'000) })
+    {
+        const Scene scene = makeScene(count);
+
+        std::vector<mat4s> reference(count);
+        std::vector<mat4s> batched(count);
+
+        const double referenceTime = bestOf([&]{ writeReference(scene, reference.data()); });
+        const double batchedTime   = bestOf([&]{ scene.transforms.writeModelViewProjection(viewProjection, &batched[0].raw[0][0], 0, count); });
+
+        float maxError = 0.f;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* a = &reference[i].raw[0][0];
+            const float* b = &batched[i].raw[0][0];
+
+            for (int j = 0; j < 16; ++j)
+                maxError = std::max(maxError, std::fabs(a[j] - b[j]) / std::max(1.f, std::fabs(a[j])));
+        }
+
+        printf("%10zu %16.2f %16.2f %9.2fx %12.3g\n", count, referenceTime / count, batchedTime / count, referenceTime / batchedTime, maxError);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef TRANSFORM_BENCHMARK_HPP
+#define TRANSFORM_BENCHMARK_HPP
+
+// Compares the per-object cglm MVP path against the batched TransformArray kernel
+// at 1k, 100k and 1M objects. Runs without a window or a Vulkan device.
+int runTransformBenchmark() noexcept;
+
+#endif // !TRANSFORM_BENCHMARK_HPP
\ No newline at end of file
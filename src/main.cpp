@@ -1,9 +1,19 @@
+#include "LaunchOptions.hpp"
 #include "Application.hpp"
+#include "benchmark/TransformBenchmark.hpp"
 
 
-int main()
+int main(int argc, char** argv)
 {
+    LaunchOptions options;
+
+    if(!options.parse(argc, argv))
+        return -1;
+
+    if(options.benchTransforms)
+        return runTransformBenchmark();
+
     Application app;
 
-    return app.run();
+    return app.run(options);
 }
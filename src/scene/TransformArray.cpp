@@ -0,0 +1,363 @@
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <immintrin.h>
+    #define TRANSFORM_KERNEL_SSE
+    #define TRANSFORM_KERNEL_AVX2
+
+//  the AVX2 kernel is compiled for its own target and only called when the CPU reports AVX2 and FMA
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define TRANSFORM_TARGET_AVX2
+    #else
+        #define TRANSFORM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #endif
+#endif
+
+#include "scene/TransformArray.hpp"
+
+
+namespace
+{
+    struct TransformStreams
+    {
+        const float* px;
+        const float* py;
+        const float* pz;
+        const float* qx;
+        const float* qy;
+        const float* qz;
+        const float* qw;
+        const float* sx;
+        const float* sy;
+        const float* sz;
+    };
+
+
+//  vp is column-major: vp[column * 4 + row]
+    void transform_scalar(const float* vp, const TransformStreams& s, size_t first, size_t last, float* dst) noexcept
+    {
+        for (size_t i = first; i < last; ++i, dst += 16)
+        {
+            const float x = s.qx[i];
+            const float y = s.qy[i];
+            const float z = s.qz[i];
+            const float w = s.qw[i];
+
+            // columns of rotation * scale, then the translation column
+            const float m[4][3] =
+            {
+                { (1.f - 2.f * (y * y + z * z)) * s.sx[i], 2.f * (x * y + w * z) * s.sx[i],         2.f * (x * z - w * y) * s.sx[i] },
+                { 2.f * (x * y - w * z) * s.sy[i],         (1.f - 2.f * (x * x + z * z)) * s.sy[i], 2.f * (y * z + w * x) * s.sy[i] },
+                { 2.f * (x * z + w * y) * s.sz[i],         2.f * (y * z - w * x) * s.sz[i],         (1.f - 2.f * (x * x + y * y)) * s.sz[i] },
+                { s.px[i],                                 s.py[i],                                 s.pz[i] }
+            };
+
+            for (int c = 0; c < 4; ++c)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    float value = vp[j] * m[c][0] + vp[4 + j] * m[c][1] + vp[8 + j] * m[c][2];
+
+                    if (c == 3)
+                        value += vp[12 + j];
+
+                    dst[c * 4 + j] = value;
+                }
+            }
+        }
+    }
+
+
+#ifdef TRANSFORM_KERNEL_SSE
+    void transform_sse(const float* vp, const TransformStreams& s, size_t first, size_t last, float* dst) noexcept
+    {
+        __m128 VP[16];
+
+        for (int k = 0; k < 16; ++k)
+            VP[k] = _mm_set1_ps(vp[k]);
+
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 two = _mm_set1_ps(2.f);
+
+        size_t i = first;
+
+        for (; i + 4 <= last; i += 4, dst += 64)
+        {
+            const __m128 x = _mm_loadu_ps(s.qx + i);
+            const __m128 y = _mm_loadu_ps(s.qy + i);
+            const __m128 z = _mm_loadu_ps(s.qz + i);
+            const __m128 w = _mm_loadu_ps(s.qw + i);
+
+            const __m128 sx = _mm_loadu_ps(s.sx + i);
+            const __m128 sy = _mm_loadu_ps(s.sy + i);
+            const __m128 sz = _mm_loadu_ps(s.sz + i);
+
+            const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+            const __m128 m[4][3] =
+            {
+                {
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx)
+                },
+                {
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy)
+                },
+                {
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz)
+                },
+                {
+                    _mm_loadu_ps(s.px + i),
+                    _mm_loadu_ps(s.py + i),
+                    _mm_loadu_ps(s.pz + i)
+                }
+            };
+
+            for (int c = 0; c < 4; ++c)
+            {
+                __m128 r[4];
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    r[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(VP[j], m[c][0]), _mm_mul_ps(VP[4 + j], m[c][1])), _mm_mul_ps(VP[8 + j], m[c][2]));
+
+                    if (c == 3)
+                        r[j] = _mm_add_ps(r[j], VP[12 + j]);
+                }
+
+                // lanes hold objects, rows hold matrix rows: transpose to get one column per object
+                _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+                for (int k = 0; k < 4; ++k)
+                    _mm_storeu_ps(dst + k * 16 + c * 4, r[k]);
+            }
+        }
+
+        transform_scalar(vp, s, i, last, dst);
+    }
+#endif // !TRANSFORM_KERNEL_SSE
+
+
+#ifdef TRANSFORM_KERNEL_AVX2
+    bool cpu_supports_avx2() noexcept
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+
+        if(info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+
+        const bool fma     = info[2] & (1 << 12);
+        const bool osxsave = info[2] & (1 << 27);
+        const bool avx     = info[2] & (1 << 28);
+
+    //  the OS has to save the YMM registers, XCR0 bits 1 and 2
+        if(!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+
+        return info[1] & (1 << 5);
+    #else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    #endif
+    }
+
+
+    TRANSFORM_TARGET_AVX2 void transform_avx2(const float* vp, const TransformStreams& s, size_t first, size_t last, float* dst) noexcept
+    {
+        __m256 VP[16];
+
+        for (int k = 0; k < 16; ++k)
+            VP[k] = _mm256_set1_ps(vp[k]);
+
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 two = _mm256_set1_ps(2.f);
+
+        size_t i = first;
+
+        for (; i + 8 <= last; i += 8, dst += 128)
+        {
+            const __m256 x = _mm256_loadu_ps(s.qx + i);
+            const __m256 y = _mm256_loadu_ps(s.qy + i);
+            const __m256 z = _mm256_loadu_ps(s.qz + i);
+            const __m256 w = _mm256_loadu_ps(s.qw + i);
+
+            const __m256 sx = _mm256_loadu_ps(s.sx + i);
+            const __m256 sy = _mm256_loadu_ps(s.sy + i);
+            const __m256 sz = _mm256_loadu_ps(s.sz + i);
+
+            const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+            const __m256 m[4][3] =
+            {
+                {
+                    _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx)
+                },
+                {
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                    _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy)
+                },
+                {
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                    _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz)
+                },
+                {
+                    _mm256_loadu_ps(s.px + i),
+                    _mm256_loadu_ps(s.py + i),
+                    _mm256_loadu_ps(s.pz + i)
+                }
+            };
+
+            for (int c = 0; c < 4; ++c)
+            {
+                __m128 lo[4];
+                __m128 hi[4];
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    __m256 r = (c == 3) ? _mm256_fmadd_ps(VP[j], m[c][0], VP[12 + j]) : _mm256_mul_ps(VP[j], m[c][0]);
+                    r = _mm256_fmadd_ps(VP[4 + j], m[c][1], r);
+                    r = _mm256_fmadd_ps(VP[8 + j], m[c][2], r);
+
+                    lo[j] = _mm256_castps256_ps128(r);
+                    hi[j] = _mm256_extractf128_ps(r, 1);
+                }
+
+                _MM_TRANSPOSE4_PS(lo[0], lo[1], lo[2], lo[3]);
+                _MM_TRANSPOSE4_PS(hi[0], hi[1], hi[2], hi[3]);
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    _mm_storeu_ps(dst + k * 16 + c * 4, lo[k]);
+                    _mm_storeu_ps(dst + (k + 4) * 16 + c * 4, hi[k]);
+                }
+            }
+        }
+
+        transform_scalar(vp, s, i, last, dst);
+    }
+#endif // !TRANSFORM_KERNEL_AVX2
+
+
+    bool use_avx2() noexcept
+    {
+#if defined(TRANSFORM_KERNEL_AVX2)
+        static const bool supported = cpu_supports_avx2();
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+
+    void transform(const float* vp, const TransformStreams& s, size_t first, size_t last, float* dst) noexcept
+    {
+#if defined(TRANSFORM_KERNEL_AVX2)
+        if(use_avx2())
+        {
+            transform_avx2(vp, s, first, last, dst);
+            return;
+        }
+#endif
+
+#if defined(TRANSFORM_KERNEL_SSE)
+        transform_sse(vp, s, first, last, dst);
+#else
+        transform_scalar(vp, s, first, last, dst);
+#endif
+    }
+}
+
+
+void TransformArray::reserve(size_t count) noexcept
+{
+    for (auto stream : { &m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ, &m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ })
+        stream->reserve(count);
+}
+
+
+void TransformArray::clear() noexcept
+{
+    for (auto stream : { &m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ, &m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ })
+        stream->clear();
+}
+
+
+size_t TransformArray::push(vec3s position, versors rotation, vec3s scale) noexcept
+{
+    m_positionX.push_back(position.x);
+    m_positionY.push_back(position.y);
+    m_positionZ.push_back(position.z);
+
+    m_rotationX.push_back(rotation.x);
+    m_rotationY.push_back(rotation.y);
+    m_rotationZ.push_back(rotation.z);
+    m_rotationW.push_back(rotation.w);
+
+    m_scaleX.push_back(scale.x);
+    m_scaleY.push_back(scale.y);
+    m_scaleZ.push_back(scale.z);
+
+    return m_positionX.size() - 1;
+}
+
+
+size_t TransformArray::size() const noexcept
+{
+    return m_positionX.size();
+}
+
+
+void TransformArray::writeModelViewProjection(const mat4s& viewProjection, float* dst, size_t first, size_t count) const noexcept
+{
+    const TransformStreams streams =
+    {
+        .px = m_positionX.data(),
+        .py = m_positionY.data(),
+        .pz = m_positionZ.data(),
+        .qx = m_rotationX.data(),
+        .qy = m_rotationY.data(),
+        .qz = m_rotationZ.data(),
+        .qw = m_rotationW.data(),
+        .sx = m_scaleX.data(),
+        .sy = m_scaleY.data(),
+        .sz = m_scaleZ.data()
+    };
+
+    transform(&viewProjection.raw[0][0], streams, first, first + count, dst);
+}
+
+
+void TransformArray::writeModelMatrices(float* dst, size_t first, size_t count) const noexcept
+{
+    writeModelViewProjection(glms_mat4_identity(), dst, first, count);
+}
+
+
+const char* TransformArray::getKernelName() noexcept
+{
+    if(use_avx2())
+        return "avx2";
+
+#if defined(TRANSFORM_KERNEL_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef TRANSFORM_ARRAY_HPP
+#define TRANSFORM_ARRAY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <cglm/struct/vec3.h>
+#include <cglm/struct/quat.h>
+#include <cglm/struct/mat4.h>
+
+// Structure-of-arrays storage for object transforms (translation * rotation * scale).
+// Matrices are produced in batches by a SIMD kernel, 4 objects per iteration with SSE or 8 with AVX2 + FMA,
+// picked at runtime from what the CPU reports.
+// The legacy draw path keeps one push constant per draw, so its matrices go to a CPU array read by the recording threads;
+// the instance buffer of the instanced and indirect paths is written straight into mapped upload memory.
+class TransformArray
+{
+public:
+    void reserve(size_t count) noexcept;
+    void clear() noexcept;
+
+    size_t push(vec3s position, versors rotation, vec3s scale) noexcept;
+    size_t size() const noexcept;
+
+//  dst receives 16 floats (column-major mat4) per object. Matrices are written front to back and dst is
+//  never read, so it may point straight into mapped write-combined GPU memory.
+    void writeModelViewProjection(const mat4s& viewProjection, float* dst, size_t first, size_t count) const noexcept;
+    void writeModelMatrices(float* dst, size_t first, size_t count) const noexcept;
+
+    static const char* getKernelName() noexcept;
+
+private:
+    std::vector<float> m_positionX;
+    std::vector<float> m_positionY;
+    std::vector<float> m_positionZ;
+
+    std::vector<float> m_rotationX;
+    std::vector<float> m_rotationY;
+    std::vector<float> m_rotationZ;
+    std::vector<float> m_rotationW;
+
+    std::vector<float> m_scaleX;
+    std::vector<float> m_scaleY;
+    std::vector<float> m_scaleZ;
+};
+
+#endif // !TRANSFORM_ARRAY_HPP
\ No newline at end of file
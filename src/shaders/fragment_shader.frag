@@ -1,12 +1,25 @@
 #version 460
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(binding = 0) uniform sampler2D texSampler;
+// the global texture table, see TextureTable
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
 layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
+// the wireframe variant turns texturing off, the branch is folded away when the pipeline is built
+layout(constant_id = 0) const bool TEXTURED = true;
+
 void main() 
 {
-    outColor = texture(texSampler, fragTexCoord);
+    if (!TEXTURED)
+    {
+        outColor = vec4(0.9f, 0.9f, 0.9f, 1.f);
+        return;
+    }
+
+    // instances of one draw may pick different textures, so the index is not dynamically uniform
+    outColor = texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord);
 }
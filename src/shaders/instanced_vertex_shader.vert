@@ -0,0 +1,29 @@
+#version 460
+
+layout(push_constant) uniform constants 
+{
+    mat4 viewProjection;
+} camera;
+
+layout(std430, binding = 0) readonly buffer Instances
+{
+    mat4 models[];
+} instances;
+
+layout(std430, binding = 1) readonly buffer Materials
+{
+    uint textureIndices[];
+} materials;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureIndex;
+
+void main() 
+{
+    gl_Position = camera.viewProjection * instances.models[gl_InstanceIndex] * vec4(inPosition, 1.f);
+    fragTexCoord = inTexCoord;
+    fragTextureIndex = materials.textureIndices[gl_InstanceIndex];
+}
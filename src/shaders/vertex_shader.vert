@@ -3,15 +3,18 @@
 layout(push_constant) uniform constants 
 {
     mat4 modelViewProjection;
+    uint textureIndex;
 } matrices;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragTextureIndex;
 
 void main() 
 {
     gl_Position = matrices.modelViewProjection * vec4(inPosition, 1.f);
     fragTexCoord = inTexCoord;
+    fragTextureIndex = matrices.textureIndex;
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "utils/AssetArchive.hpp"
+
+// Packs every file under the given directories into one AssetArchive.
+// Assets are named by their path relative to BASE_DIR with forward slashes, the same string the runtime would open them by,
+// e.g. AssetPacker res/assets.pak . res/shaders res/textures stores "res/shaders/vertex_shader.spv".
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        printf("usage: %s OUTPUT BASE_DIR DIR...\n", argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path output = argv[1];
+    const std::filesystem::path base = argv[2];
+
+    std::vector<AssetArchive::Source> sources;
+    std::error_code error;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        for (const auto& it : std::filesystem::recursive_directory_iterator(argv[i], error))
+        {
+            if (!it.is_regular_file() || std::filesystem::equivalent(it.path(), output, error))
+                continue;
+
+            sources.push_back({ std::filesystem::relative(it.path(), base).generic_string(), it.path() });
+        }
+
+        if (error)
+        {
+            printf("failed to list %s: %s\n", argv[i], error.message().c_str());
+            return 1;
+        }
+    }
+
+    if (!AssetArchive::write(output, sources))
+        return 1;
+
+    printf("packed %zu assets into %s\n", sources.size(), output.string().c_str());
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "utils/Trace.hpp"
+#include "utils/AssetArchive.hpp"
+
+
+namespace
+{
+    uint64_t align_up(uint64_t value, uint64_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+
+    bool read_file(const std::filesystem::path& path, std::vector<char>& content) noexcept
+    {
+        std::ifstream stream;
+        stream.open(path, std::ios::ate | std::ios::binary);
+
+        if (!stream.is_open())
+            return false;
+
+        content.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(content.data(), content.size());
+
+        return static_cast<bool>(stream);
+    }
+}
+
+
+
+AssetArchive::AssetArchive() noexcept:
+    m_data(nullptr),
+    m_size(0),
+    m_entries(nullptr),
+    m_entryCount(0),
+    m_names(nullptr)
+#ifdef _WIN32
+    , m_file(nullptr),
+    m_mapping(nullptr)
+#endif
+{
+
+}
+
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+
+bool AssetArchive::write(const std::filesystem::path& path, std::span<const Source> sources) noexcept
+{
+    std::vector<const Source*> sorted;
+
+    for (const auto& source : sources)
+        sorted.push_back(&source);
+
+    std::sort(sorted.begin(), sorted.end(), [](const Source* a, const Source* b) { return a->name < b->name; });
+
+    if (std::adjacent_find(sorted.begin(), sorted.end(), [](const Source* a, const Source* b) { return a->name == b->name; }) != sorted.end())
+    {
+        printf("asset names in an archive must be unique\n");
+        return false;
+    }
+
+    Header header = 
+    {
+        .magic       = MAGIC,
+        .version     = VERSION,
+        .entryCount  = static_cast<uint32_t>(sorted.size()),
+        .alignment   = static_cast<uint32_t>(ALIGNMENT),
+        .namesOffset = sizeof(Header) + sorted.size() * sizeof(Entry),
+        .namesSize   = 0
+    };
+
+    std::vector<Entry> entries(sorted.size());
+    std::string names;
+
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameLength = static_cast<uint32_t>(sorted[i]->name.size());
+        names += sorted[i]->name;
+    }
+
+    header.namesSize = names.size();
+
+//  written next to the target and renamed once complete, so a failed pack never leaves a truncated archive behind
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    std::error_code error;
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+
+    if (!stream.is_open())
+    {
+        printf("failed to create %s\n", temporary.string().c_str());
+        return false;
+    }
+
+    uint64_t offset = header.namesOffset + header.namesSize;
+    std::vector<char> content;
+    const std::vector<char> padding(ALIGNMENT, 0);
+
+    stream.seekp(static_cast<std::streamoff>(offset));
+
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        if (!read_file(sorted[i]->path, content))
+        {
+            printf("failed to read %s\n", sorted[i]->path.string().c_str());
+            stream.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+
+        const uint64_t aligned = align_up(offset, ALIGNMENT);
+        stream.write(padding.data(), static_cast<std::streamsize>(aligned - offset));
+        stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+
+        entries[i].offset = aligned;
+        entries[i].size   = content.size();
+        entries[i].hash   = hash({ reinterpret_cast<const uint8_t*>(content.data()), content.size() });
+
+        offset = aligned + content.size();
+    }
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    stream.write(names.data(), static_cast<std::streamsize>(names.size()));
+    stream.close();
+
+    if (!stream)
+    {
+        printf("failed to write %s\n", temporary.string().c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, path, error);
+
+    if (error)
+    {
+        printf("failed to replace %s: %s\n", path.string().c_str(), error.message().c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+
+uint64_t AssetArchive::hash(std::span<const uint8_t> data) noexcept
+{
+    uint64_t value = 0xCBF29CE484222325ULL;
+
+    for (const uint8_t byte : data)
+    {
+        value ^= byte;
+        value *= 0x100000001B3ULL;
+    }
+
+    return value;
+}
+
+
+bool AssetArchive::open(const std::filesystem::path& path) noexcept
+{
+    TRACE_SCOPE("AssetArchive::open");
+
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (GetFileSizeEx(m_file, &fileSize) && fileSize.QuadPart > 0)
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping)
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!m_data)
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+        mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+//  the mapping keeps the file alive on its own
+    ::close(file);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+//  startup reads most of the archive, so the kernel may read it ahead in one sequential pass
+    madvise(mapping, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const uint8_t*>(mapping);
+    m_size = static_cast<uint64_t>(status.st_size);
+#endif
+
+    Header header;
+
+    if (m_size < sizeof(header))
+    {
+        close();
+        return false;
+    }
+
+    memcpy(&header, m_data, sizeof(header));
+
+    const bool valid = header.magic == MAGIC && header.version == VERSION &&
+                       header.alignment != 0 && (header.alignment & (header.alignment - 1)) == 0 &&
+                       header.namesOffset >= sizeof(Header) + static_cast<uint64_t>(header.entryCount) * sizeof(Entry) &&
+                       header.namesOffset <= m_size && header.namesSize <= m_size - header.namesOffset;
+
+    if (!valid)
+    {
+        printf("%s is not a valid asset archive\n", path.string().c_str());
+        close();
+        return false;
+    }
+
+    m_entries    = reinterpret_cast<const Entry*>(m_data + sizeof(Header));
+    m_entryCount = header.entryCount;
+    m_names      = reinterpret_cast<const char*>(m_data + header.namesOffset);
+
+    for (uint32_t i = 0; i < m_entryCount; ++i)
+    {
+        const Entry& entry = m_entries[i];
+
+        const bool entryValid = static_cast<uint64_t>(entry.nameOffset) + entry.nameLength <= header.namesSize &&
+                                entry.offset % header.alignment == 0 && entry.offset <= m_size && entry.size <= m_size - entry.offset &&
+                                (i == 0 || getName(m_entries[i - 1]) < getName(entry));
+
+        if (!entryValid)
+        {
+            printf("%s has a corrupt table of contents\n", path.string().c_str());
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void AssetArchive::close() noexcept
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file)
+        CloseHandle(m_file);
+
+    m_file = nullptr;
+    m_mapping = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_names = nullptr;
+}
+
+
+uint32_t AssetArchive::verify() const noexcept
+{
+    TRACE_SCOPE("AssetArchive::verify");
+
+    uint32_t mismatches = 0;
+
+    for (uint32_t i = 0; i < m_entryCount; ++i)
+    {
+        const Entry& entry = m_entries[i];
+
+        if (hash({ m_data + entry.offset, static_cast<size_t>(entry.size) }) != entry.hash)
+        {
+            const std::string_view name = getName(entry);
+            printf("asset %.*s does not match its hash\n", static_cast<int>(name.size()), name.data());
+            ++mismatches;
+        }
+    }
+
+    return mismatches;
+}
+
+
+std::span<const uint8_t> AssetArchive::find(std::string_view name) const noexcept
+{
+    const Entry* entry = findEntry(name);
+
+    return entry ? std::span<const uint8_t>(m_data + entry->offset, static_cast<size_t>(entry->size)) : std::span<const uint8_t>();
+}
+
+
+bool AssetArchive::contains(std::string_view name) const noexcept
+{
+    return findEntry(name) != nullptr;
+}
+
+
+bool AssetArchive::isOpen() const noexcept
+{
+    return m_data != nullptr;
+}
+
+
+uint32_t AssetArchive::getEntryCount() const noexcept
+{
+    return m_entryCount;
+}
+
+
+uint64_t AssetArchive::getSize() const noexcept
+{
+    return m_size;
+}
+
+
+const AssetArchive::Entry* AssetArchive::findEntry(std::string_view name) const noexcept
+{
+    const Entry* end = m_entries + m_entryCount;
+    const Entry* entry = std::lower_bound(m_entries, end, name, [this](const Entry& e, std::string_view n) { return getName(e) < n; });
+
+    return (entry != end && getName(*entry) == name) ? entry : nullptr;
+}
+
+
+std::string_view AssetArchive::getName(const Entry& entry) const noexcept
+{
+    return { m_names + entry.nameOffset, entry.nameLength };
+}
\ No newline at end of file
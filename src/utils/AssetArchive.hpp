@@ -0,0 +1,87 @@
+#ifndef ASSET_ARCHIVE_HPP
+#define ASSET_ARCHIVE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A read-only pack of asset files, mapped into memory as a whole.
+// The file starts with a header, followed by a table of contents sorted by name, the names, and the payloads, each
+// aligned to ALIGNMENT and hashed with 64-bit FNV-1a. Payloads are handed out as views into the mapping, so they can be
+// copied straight into staging memory or passed to vkCreateShaderModule. Every field is little-endian.
+class AssetArchive
+{
+public:
+    static constexpr uint32_t MAGIC     = 0x4B504356; // "VCPK"
+    static constexpr uint32_t VERSION   = 1;
+    static constexpr uint64_t ALIGNMENT = 64;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t alignment;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+    };
+
+    struct Entry
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t hash;
+        uint32_t nameOffset; // into the names
+        uint32_t nameLength;
+    };
+
+    struct Source
+    {
+        std::string           name; // what find() looks the asset up by
+        std::filesystem::path path;
+    };
+
+    AssetArchive() noexcept;
+    AssetArchive(const AssetArchive&) noexcept = delete;
+    AssetArchive& operator = (const AssetArchive&) noexcept = delete;
+    ~AssetArchive();
+
+//  Packs the files into one archive at path
+    static bool write(const std::filesystem::path& path, std::span<const Source> sources) noexcept;
+
+    static uint64_t hash(std::span<const uint8_t> data) noexcept;
+
+//  Maps the archive and checks that its table of contents is consistent, payloads are not hashed here
+    bool open(const std::filesystem::path& path) noexcept;
+    void close() noexcept;
+
+//  Hashes every payload, returns the number that do not match their table of contents entry
+    uint32_t verify() const noexcept;
+
+//  An empty span when the archive holds no asset of that name, views stay valid until close()
+    std::span<const uint8_t> find(std::string_view name) const noexcept;
+    bool contains(std::string_view name) const noexcept;
+
+    bool     isOpen()        const noexcept;
+    uint32_t getEntryCount() const noexcept;
+    uint64_t getSize()       const noexcept;
+
+private:
+    const Entry*     findEntry(std::string_view name) const noexcept;
+    std::string_view getName(const Entry& entry) const noexcept;
+
+    const uint8_t* m_data;
+    uint64_t       m_size;
+    const Entry*   m_entries;
+    uint32_t       m_entryCount;
+    const char*    m_names;
+#ifdef _WIN32
+    void*          m_file;
+    void*          m_mapping;
+#endif
+};
+
+#endif // !ASSET_ARCHIVE_HPP
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "utils/ThreadPool.hpp"
+
+
+ThreadPool::ThreadPool(uint32_t threadCount) noexcept:
+    m_pending(0),
+    m_stopping(false)
+{
+    if(threadCount == 0)
+        threadCount = 1;
+
+    m_threads.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_taskAvailable.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+
+void ThreadPool::submit(Task task) noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+        ++m_pending;
+    }
+
+    m_taskAvailable.notify_one();
+}
+
+
+void ThreadPool::wait() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    m_tasksDone.wait(lock, [this] { return m_pending == 0; });
+}
+
+
+uint32_t ThreadPool::getThreadCount() const noexcept
+{
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+
+void ThreadPool::workerLoop(uint32_t workerIndex) noexcept
+{
+    while (true)
+    {
+        Task task;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_taskAvailable.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task(workerIndex);
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            if (--m_pending == 0)
+                m_tasksDone.notify_all();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+class ThreadPool
+{
+public:
+    using Task = std::function<void(uint32_t workerIndex)>;
+
+    explicit ThreadPool(uint32_t threadCount) noexcept;
+    ThreadPool(const ThreadPool&) noexcept = delete;
+    ThreadPool(ThreadPool&&) noexcept = delete;
+    ThreadPool& operator = (const ThreadPool&) noexcept = delete;
+    ThreadPool& operator = (ThreadPool&&) noexcept = delete;
+    ~ThreadPool();
+
+    void submit(Task task) noexcept;
+    void wait() noexcept;
+
+    uint32_t getThreadCount() const noexcept;
+
+private:
+    void workerLoop(uint32_t workerIndex) noexcept;
+
+    std::vector<std::thread> m_threads;
+    std::deque<Task>         m_tasks;
+    std::mutex               m_mutex;
+    std::condition_variable  m_taskAvailable;
+    std::condition_variable  m_tasksDone;
+    uint32_t                 m_pending;
+    bool                     m_stopping;
+};
+
+#endif // !THREAD_POOL_HPP
\ No newline at end of file
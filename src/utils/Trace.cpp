@@ -0,0 +1,129 @@
+#ifdef ENABLE_TRACING
+
+#include <cstdio>
+#include <chrono>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "utils/Trace.hpp"
+
+
+namespace
+{
+    constexpr size_t RING_CAPACITY = 1 << 16; // per thread, power of two
+
+    struct Event
+    {
+        const char* name;
+        uint64_t    begin;
+        uint64_t    end;
+    };
+
+    struct ThreadRing
+    {
+        std::array<Event, RING_CAPACITY> events;
+        std::atomic<uint64_t>            head { 0 }; // only the owning thread writes
+        uint32_t                         threadId = 0;
+    };
+
+//  Rings are never freed, so a thread that already exited still shows up in the dump
+    struct Registry
+    {
+        std::mutex                               mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+    };
+
+
+    Registry& get_registry() noexcept
+    {
+        static Registry registry;
+
+        return registry;
+    }
+
+
+    ThreadRing* register_thread() noexcept
+    {
+        auto ring = std::make_unique<ThreadRing>();
+        auto& registry = get_registry();
+
+        std::lock_guard lock(registry.mutex);
+        ring->threadId = static_cast<uint32_t>(registry.rings.size());
+        registry.rings.push_back(std::move(ring));
+
+        return registry.rings.back().get();
+    }
+
+
+    const uint64_t START_TIME = trace::now();
+}
+
+
+namespace trace
+{
+    uint64_t now() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+
+    void record(const char* name, uint64_t begin, uint64_t end) noexcept
+    {
+        thread_local ThreadRing* ring = register_thread();
+
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        ring->events[head & (RING_CAPACITY - 1)] = { name, begin, end };
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+
+    bool writeChromeJson(const char* path) noexcept
+    {
+        FILE* file = fopen(path, "w");
+
+        if (!file)
+        {
+            printf("failed to open %s\n", path);
+            return false;
+        }
+
+        auto& registry = get_registry();
+        std::lock_guard lock(registry.mutex);
+
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+        bool first = true;
+
+        for (const auto& ring : registry.rings)
+        {
+            const uint64_t head  = ring->head.load(std::memory_order_acquire);
+            const uint64_t count = (head < RING_CAPACITY) ? head : RING_CAPACITY;
+
+            // threads are numbered in the order they first recorded an event
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                first ? "" : ",\n", ring->threadId, ring->threadId);
+            first = false;
+
+            for (uint64_t i = head - count; i < head; ++i)
+            {
+                const Event& event = ring->events[i & (RING_CAPACITY - 1)];
+
+                // complete events, timestamps in microseconds relative to startup
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.name, ring->threadId, (event.begin - START_TIME) * 1e-3, (event.end - event.begin) * 1e-3);
+            }
+        }
+
+        fprintf(file, "\n]}\n");
+        fclose(file);
+
+        printf("trace written to %s\n", path);
+
+        return true;
+    }
+}
+
+#endif // !ENABLE_TRACING
\ No newline at end of file
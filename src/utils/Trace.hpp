@@ -0,0 +1,58 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// Scoped CPU tracing exported as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev).
+// Compiled in with ENABLE_TRACING (CMake option VULKAN_CUBES_ENABLE_TRACING), otherwise the macros expand to nothing.
+//
+// TRACE_SCOPE("name") records one complete event for the enclosing block. Names must be string literals.
+// Every thread writes into its own fixed size ring without locks, the oldest events are overwritten when it wraps.
+// TRACE_WRITE(path) must be called while no other thread is tracing, e.g. after the worker pools went idle.
+
+#ifdef ENABLE_TRACING
+
+#include <cstdint>
+
+namespace trace
+{
+    uint64_t now() noexcept; // monotonic, nanoseconds
+    void record(const char* name, uint64_t begin, uint64_t end) noexcept;
+    bool writeChromeJson(const char* path) noexcept;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) noexcept:
+            m_name(name),
+            m_begin(now())
+        {
+
+        }
+
+        ~Scope()
+        {
+            record(m_name, m_begin, now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator = (const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t    m_begin;
+    };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_WRITE(path) trace::writeChromeJson(path)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_WRITE(path) ((void)0)
+
+#endif // !ENABLE_TRACING
+
+#endif // !TRACE_HPP
\ No newline at end of file
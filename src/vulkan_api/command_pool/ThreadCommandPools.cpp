@@ -0,0 +1,81 @@
+#include "vulkan_api/command_pool/ThreadCommandPools.hpp"
+
+
+bool ThreadCommandPools::create(VkDevice device, uint32_t queueFamilyIndex, uint32_t threadCount) noexcept
+{
+    const VkCommandPoolCreateInfo poolInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queueFamilyIndex
+    };
+
+    for (auto& frame : m_frames)
+    {
+        frame.pools.resize(threadCount, nullptr);
+        frame.commandBuffers.resize(threadCount, nullptr);
+
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &frame.pools[i]) != VK_SUCCESS)
+                return false;
+
+            const VkCommandBufferAllocateInfo allocInfo = 
+            {
+                .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext              = nullptr,
+                .commandPool        = frame.pools[i],
+                .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1
+            };
+
+            if (vkAllocateCommandBuffers(device, &allocInfo, &frame.commandBuffers[i]) != VK_SUCCESS)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+void ThreadCommandPools::destroy(VkDevice device) noexcept
+{
+    for (auto& frame : m_frames)
+    {
+        for (auto pool : frame.pools)
+            if (pool)
+                vkDestroyCommandPool(device, pool, nullptr);
+
+        frame.pools.clear();
+        frame.commandBuffers.clear();
+    }
+}
+
+
+VkResult ThreadCommandPools::reset(VkDevice device, uint32_t frame) noexcept
+{
+    for (auto pool : m_frames[frame].pools)
+        if (auto result = vkResetCommandPool(device, pool, 0); result != VK_SUCCESS)
+            return result;
+
+    return VK_SUCCESS;
+}
+
+
+VkCommandBuffer ThreadCommandPools::getCommandBuffer(uint32_t frame, uint32_t thread) const noexcept
+{
+    return m_frames[frame].commandBuffers[thread];
+}
+
+
+std::span<const VkCommandBuffer> ThreadCommandPools::getCommandBuffers(uint32_t frame) const noexcept
+{
+    return m_frames[frame].commandBuffers;
+}
+
+
+uint32_t ThreadCommandPools::getThreadCount() const noexcept
+{
+    return static_cast<uint32_t>(m_frames[0].pools.size());
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef THREAD_COMMAND_POOLS_HPP
+#define THREAD_COMMAND_POOLS_HPP
+
+#include <array>
+#include <vector>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/utils/Defines.hpp"
+
+// One transient command pool and one secondary command buffer per recording thread and frame in flight,
+// so workers never share a pool and a whole frame's pools can be reset at once
+class ThreadCommandPools
+{
+public:
+    bool create(VkDevice device, uint32_t queueFamilyIndex, uint32_t threadCount) noexcept;
+    void destroy(VkDevice device) noexcept;
+
+    VkResult reset(VkDevice device, uint32_t frame) noexcept;
+
+    VkCommandBuffer getCommandBuffer(uint32_t frame, uint32_t thread) const noexcept;
+    std::span<const VkCommandBuffer> getCommandBuffers(uint32_t frame) const noexcept;
+    uint32_t getThreadCount() const noexcept;
+
+private:
+    struct FramePools
+    {
+        std::vector<VkCommandPool>   pools;
+        std::vector<VkCommandBuffer> commandBuffers;
+    };
+
+    std::array<FramePools, MAX_FRAMES_IN_FLIGHT> m_frames;
+};
+
+#endif // !THREAD_COMMAND_POOLS_HPP
\ No newline at end of file
@@ -53,7 +53,9 @@ VulkanContext::VulkanContext() noexcept:
     m_physicalDevice(nullptr),
     m_device(nullptr),
     m_queue(nullptr),
-    m_mainQueueFamilyIndex(0)
+    m_mainQueueFamilyIndex(0),
+    m_transferQueue(nullptr),
+    m_transferQueueFamilyIndex(0)
 {
 
 }
@@ -62,12 +64,20 @@ VulkanContext::VulkanContext() noexcept:
 VulkanContext::~VulkanContext() = default;
 
 
-VkResult VulkanContext::initialize() noexcept
+VkResult VulkanContext::initialize(bool headless, bool headlessSurface) noexcept
 {
-    if(createInstance() == VK_SUCCESS)
+    if(createInstance(headless, headlessSurface) == VK_SUCCESS)
         if(selectVideoCard() == VK_SUCCESS)
-            if(createDevice() == VK_SUCCESS)
-                return VK_SUCCESS;
+            if(createDevice(headless) == VK_SUCCESS)
+                if(m_allocator.create(m_physicalDevice, m_device, m_features.memoryBudget))
+                {
+                    if(!m_pipelineCache.create(m_physicalDevice, m_device, PipelineCache::DEFAULT_PATH))
+                        printf("failed to create a pipeline cache, every pipeline is compiled from scratch\n");
+
+                    m_pipelineRegistry.create(m_device);
+
+                    return VK_SUCCESS;
+                }
 
     return VK_ERROR_INITIALIZATION_FAILED;
 }
@@ -75,6 +85,10 @@ VkResult VulkanContext::initialize() noexcept
 
 void VulkanContext::destroy() noexcept
 {
+    m_pipelineRegistry.destroy();
+    m_pipelineCache.save();
+    m_pipelineCache.destroy();
+    m_allocator.destroy();
     vkDestroyDevice(m_device, VK_NULL_HANDLE);
     vkDestroyInstance(m_instance, VK_NULL_HANDLE);
 }
@@ -110,29 +124,48 @@ uint32_t VulkanContext::getMainQueueFamilyIndex() const noexcept
 }
 
 
-VkResult VulkanContext::createInstance() noexcept
+VkQueue VulkanContext::getTransferQueue() const noexcept
 {
-#ifdef DEBUG
-    if (!check_validation_layer_support())
-        return VK_ERROR_INITIALIZATION_FAILED;
-#endif // !DEBUG
+    return m_transferQueue;
+}
 
-    std::vector<const char*> requiredExtensions = 
-    {
-        VK_KHR_SURFACE_EXTENSION_NAME
-    };
 
-#ifdef _WIN32
-    requiredExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
-#endif
+uint32_t VulkanContext::getTransferQueueFamilyIndex() const noexcept
+{
+    return m_transferQueueFamilyIndex;
+}
+
+
+const VulkanContext::Features& VulkanContext::getFeatures() const noexcept
+{
+    return m_features;
+}
+
+
+MemoryAllocator& VulkanContext::getAllocator() noexcept
+{
+    return m_allocator;
+}
+
+
+PipelineCache& VulkanContext::getPipelineCache() noexcept
+{
+    return m_pipelineCache;
+}
 
-#ifdef __linux__
-    requiredExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
-#endif
 
+PipelineRegistry& VulkanContext::getPipelineRegistry() noexcept
+{
+    return m_pipelineRegistry;
+}
+
+
+VkResult VulkanContext::createInstance(bool headless, bool headlessSurface) noexcept
+{
 #ifdef DEBUG
-    requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-#endif
+    if (!check_validation_layer_support())
+        return VK_ERROR_INITIALIZATION_FAILED;
+#endif // !DEBUG
 
     uint32_t availableExtensionCount;
     vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionCount, nullptr);
@@ -145,6 +178,34 @@ VkResult VulkanContext::createInstance() noexcept
     for (const auto& it : availableExtensions)
         deviceExtensions.insert(it.extensionName);
 
+    std::vector<const char*> requiredExtensions;
+
+    if (headless)
+    {// render targets are plain images, a headless surface is only used when it was asked for and the loader offers one
+        if (headlessSurface && deviceExtensions.contains(VK_KHR_SURFACE_EXTENSION_NAME) && deviceExtensions.contains(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME))
+        {
+            requiredExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+            requiredExtensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+            m_features.headlessSurface = true;
+        }
+    }
+    else
+    {
+        requiredExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+
+#ifdef _WIN32
+        requiredExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#endif
+
+#ifdef __linux__
+        requiredExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
+#endif
+    }
+
+#ifdef DEBUG
+    requiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+#endif
+
     for (const auto it : requiredExtensions)
         if (deviceExtensions.find(it) == deviceExtensions.end())	
             return VK_ERROR_INITIALIZATION_FAILED;
@@ -231,13 +292,21 @@ VkResult VulkanContext::selectVideoCard() noexcept
         {
             m_physicalDevice = device;
         }
+        else if(auto device = find_device(VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU); device)
+        {
+            m_physicalDevice = device;
+        }
+        else if(auto device = find_device(VK_PHYSICAL_DEVICE_TYPE_CPU); device) // lavapipe, SwiftShader
+        {
+            m_physicalDevice = device;
+        }
     }
 
     return m_physicalDevice ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED;
 }
 
 
-VkResult VulkanContext::createDevice() noexcept
+VkResult VulkanContext::createDevice(bool headless) noexcept
 {
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
@@ -250,6 +319,71 @@ VkResult VulkanContext::createDevice() noexcept
     if (supportedFeatures.fillModeNonSolid)
         enabledFeatures.fillModeNonSolid = VK_TRUE;
 
+    if (supportedFeatures.multiDrawIndirect)
+        enabledFeatures.multiDrawIndirect = VK_TRUE;
+
+    if (supportedFeatures.drawIndirectFirstInstance)
+        enabledFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+    if (supportedFeatures.pipelineStatisticsQuery)
+        enabledFeatures.pipelineStatisticsQuery = VK_TRUE;
+
+    if (supportedFeatures.inheritedQueries)
+        enabledFeatures.inheritedQueries = VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features supportedFeatures12 = {};
+    supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+    supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures2.pNext = &supportedFeatures12;
+
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures2);
+
+//  frames and uploads are synchronised with timeline semaphores, core and required since Vulkan 1.2
+    if (!supportedFeatures12.timelineSemaphore)
+    {
+        printf("timeline semaphores are not supported!\n");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    VkPhysicalDeviceVulkan12Features enabledFeatures12 = {};
+    enabledFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledFeatures12.drawIndirectCount = supportedFeatures12.drawIndirectCount;
+    enabledFeatures12.timelineSemaphore = VK_TRUE;
+
+    if (supportedFeatures12.runtimeDescriptorArray &&
+        supportedFeatures12.descriptorBindingPartiallyBound &&
+        supportedFeatures12.descriptorBindingSampledImageUpdateAfterBind &&
+        supportedFeatures12.descriptorBindingUpdateUnusedWhilePending &&
+        supportedFeatures12.shaderSampledImageArrayNonUniformIndexing)
+    {
+        enabledFeatures12.runtimeDescriptorArray                       = VK_TRUE;
+        enabledFeatures12.descriptorBindingPartiallyBound              = VK_TRUE;
+        enabledFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabledFeatures12.descriptorBindingUpdateUnusedWhilePending    = VK_TRUE;
+        enabledFeatures12.shaderSampledImageArrayNonUniformIndexing    = VK_TRUE;
+    }
+
+    m_features.multiDrawIndirect         = enabledFeatures.multiDrawIndirect;
+    m_features.drawIndirectFirstInstance = enabledFeatures.drawIndirectFirstInstance;
+    m_features.drawIndirectCount         = enabledFeatures12.drawIndirectCount;
+    m_features.pipelineStatisticsQuery   = enabledFeatures.pipelineStatisticsQuery;
+    m_features.inheritedQueries          = enabledFeatures.inheritedQueries;
+    m_features.fillModeNonSolid          = enabledFeatures.fillModeNonSolid;
+    m_features.descriptorIndexing        = enabledFeatures12.runtimeDescriptorArray;
+
+    {// Memory the CPU can write straight into and the GPU reads at full speed
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
+
+        constexpr VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+            if((memoryProperties.memoryTypes[i].propertyFlags & directFlags) == directFlags)
+                m_features.hostVisibleDeviceMemory = true;
+    }
+
     {// Find main queue family index
         uint32_t queueFamilyCount;
         vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
@@ -265,26 +399,48 @@ VkResult VulkanContext::createDevice() noexcept
                 break;
             }
         }
+
+//      a family with transfer but neither graphics nor compute is usually backed by the copy engines
+        m_transferQueueFamilyIndex = m_mainQueueFamilyIndex;
+
+        for (size_t i = 0; i < queueFamilies.size(); ++i)
+        {
+            const VkQueueFlags flags = queueFamilies[i].queueFlags;
+
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            {
+                m_transferQueueFamilyIndex = static_cast<uint32_t>(i);
+                break;
+            }
+        }
+
+        m_features.dedicatedTransferQueue = (m_transferQueueFamilyIndex != m_mainQueueFamilyIndex);
     }
 
 	if(m_mainQueueFamilyIndex != UINT32_MAX)
     {
         const float queuePriority = 1.0f;
 
-    	const VkDeviceQueueCreateInfo queueInfo = 
-        {
-            .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .pNext            = nullptr,
-            .flags            = 0,
-            .queueFamilyIndex = m_mainQueueFamilyIndex,
-            .queueCount       = 1,
-            .pQueuePriorities = &queuePriority
-        };
-
-        constexpr std::array<const char*, 2> requiredExtensions = 
+    	const std::array<VkDeviceQueueCreateInfo, 2> queueInfos = 
         {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-            VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
+            VkDeviceQueueCreateInfo
+            {
+                .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext            = nullptr,
+                .flags            = 0,
+                .queueFamilyIndex = m_mainQueueFamilyIndex,
+                .queueCount       = 1,
+                .pQueuePriorities = &queuePriority
+            },
+            VkDeviceQueueCreateInfo
+            {
+                .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .pNext            = nullptr,
+                .flags            = 0,
+                .queueFamilyIndex = m_transferQueueFamilyIndex,
+                .queueCount       = 1,
+                .pQueuePriorities = &queuePriority
+            }
         };
 
         uint32_t extensionCount;
@@ -298,23 +454,65 @@ VkResult VulkanContext::createDevice() noexcept
         for (const auto& it : availableExtensions)
             deviceExtensions.insert(it.extensionName);
 
+        std::vector<const char*> requiredExtensions = 
+        {
+            VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME
+        };
+
+        if (headless && !deviceExtensions.contains(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+            m_features.headlessSurface = false;
+
+        if (!headless || m_features.headlessSurface)
+            requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
         for (const auto& extension : requiredExtensions)
             if(deviceExtensions.find(extension) == deviceExtensions.end())
                 return VK_ERROR_INITIALIZATION_FAILED;
 
-        constexpr VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_feature = 
+        m_features.memoryBudget = deviceExtensions.contains(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        if (m_features.memoryBudget)
+            requiredExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3 = {};
+        extendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+        if (deviceExtensions.contains(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+        {
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &extendedDynamicState3;
+
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+//          only the two states the pipelines leave dynamic are enabled
+            m_features.extendedDynamicState = extendedDynamicState3.extendedDynamicState3PolygonMode && extendedDynamicState3.extendedDynamicState3ColorBlendEnable;
+
+            extendedDynamicState3 = {};
+            extendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+            extendedDynamicState3.extendedDynamicState3PolygonMode      = m_features.extendedDynamicState;
+            extendedDynamicState3.extendedDynamicState3ColorBlendEnable = m_features.extendedDynamicState;
+        }
+
+        if (m_features.extendedDynamicState)
+            requiredExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_feature = 
         {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = m_features.extendedDynamicState ? &extendedDynamicState3 : nullptr,
             .dynamicRendering = VK_TRUE
         };
 
+        enabledFeatures12.pNext = &dynamic_rendering_feature;
+
         VkDeviceCreateInfo deviceInfo = 
         {
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext                   = &dynamic_rendering_feature,
+            .pNext                   = &enabledFeatures12,
             .flags                   = 0,
-            .queueCreateInfoCount    = 1,
-            .pQueueCreateInfos       = &queueInfo,
+            .queueCreateInfoCount    = m_features.dedicatedTransferQueue ? 2U : 1U,
+            .pQueueCreateInfos       = queueInfos.data(),
             .enabledLayerCount       = 0,
             .ppEnabledLayerNames     = nullptr,
             .enabledExtensionCount   = static_cast<uint32_t>(requiredExtensions.size()),
@@ -329,6 +527,7 @@ VkResult VulkanContext::createDevice() noexcept
         if(vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device) == VK_SUCCESS)
         {
             vkGetDeviceQueue(m_device, m_mainQueueFamilyIndex, 0, &m_queue);
+            vkGetDeviceQueue(m_device, m_transferQueueFamilyIndex, 0, &m_transferQueue);
 
             return VK_SUCCESS;
         }
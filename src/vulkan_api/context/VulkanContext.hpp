@@ -3,14 +3,38 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+#include "vulkan_api/pipeline/PipelineCache.hpp"
+#include "vulkan_api/pipeline/PipelineRegistry.hpp"
+
 
 class VulkanContext
 {
 public:
+    struct Features
+    {
+        bool multiDrawIndirect         = false;
+        bool drawIndirectFirstInstance = false;
+        bool drawIndirectCount         = false;
+        bool pipelineStatisticsQuery   = false;
+        bool inheritedQueries          = false;
+        bool fillModeNonSolid          = false; // line and point polygon modes
+        bool descriptorIndexing        = false; // partially bound, update-after-bind, non-uniformly indexed sampled image arrays
+        bool dedicatedTransferQueue    = false; // a transfer-only queue family, otherwise transfers share the main queue
+        bool headlessSurface           = false; // VK_EXT_headless_surface + swapchain, headless contexts that asked for it only
+        bool memoryBudget              = false; // VK_EXT_memory_budget, heap budgets come from the driver instead of an estimate
+        bool hostVisibleDeviceMemory   = false; // a DEVICE_LOCAL | HOST_VISIBLE | HOST_COHERENT memory type, UMA or resizable BAR
+        bool extendedDynamicState      = false; // VK_EXT_extended_dynamic_state3 polygon mode and color blend enable, on top of the 1.3 core dynamic state
+    };
+
     VulkanContext() noexcept;
     ~VulkanContext();
 
-    VkResult initialize() noexcept;
+//  A headless context does not require any window system integration extensions,
+//  VK_EXT_headless_surface and the swapchain are only asked for with headlessSurface, and only used when available
+    VkResult initialize(bool headless = false, bool headlessSurface = false) noexcept;
+
+//  Destroys every pipeline in the registry and writes the pipeline cache back to disk before the device goes away
     void destroy() noexcept;
 
     VkInstance       getInstance()             const noexcept;
@@ -18,17 +42,29 @@ public:
     VkDevice         getDevice()               const noexcept;
     VkQueue          getQueue()                const noexcept;
     uint32_t         getMainQueueFamilyIndex() const noexcept;
+    VkQueue          getTransferQueue()        const noexcept;
+    uint32_t         getTransferQueueFamilyIndex() const noexcept;
+    const Features&  getFeatures()             const noexcept;
+    MemoryAllocator& getAllocator()                  noexcept;
+    PipelineCache&   getPipelineCache()              noexcept;
+    PipelineRegistry& getPipelineRegistry()          noexcept;
 
 private:
-    VkResult createInstance()  noexcept;
+    VkResult createInstance(bool headless, bool headlessSurface) noexcept;
     VkResult selectVideoCard() noexcept;
-    VkResult createDevice()    noexcept;
+    VkResult createDevice(bool headless) noexcept;
 
     VkInstance       m_instance;
     VkPhysicalDevice m_physicalDevice;
     VkDevice         m_device;
     VkQueue          m_queue;
     uint32_t         m_mainQueueFamilyIndex;
+    VkQueue          m_transferQueue;
+    uint32_t         m_transferQueueFamilyIndex;
+    Features         m_features;
+    MemoryAllocator  m_allocator;
+    PipelineCache    m_pipelineCache;
+    PipelineRegistry m_pipelineRegistry;
 };
 
 #endif // !VULKAN_CONTEXT_HPP
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+
+
+MemoryAllocator::MemoryAllocator() noexcept:
+    m_GPU(nullptr),
+    m_device(nullptr),
+    m_memoryProperties(),
+    m_bufferImageGranularity(1),
+    m_memoryBudget(false),
+    m_nextBlockId(1),
+    m_dedicatedCount(0),
+    m_dedicatedBytes(0),
+    m_fallbackCount(0)
+{
+
+}
+
+
+bool MemoryAllocator::create(VkPhysicalDevice GPU, VkDevice device, bool memoryBudget) noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GPU, &properties);
+    vkGetPhysicalDeviceMemoryProperties(GPU, &m_memoryProperties);
+
+    m_GPU = GPU;
+    m_device = device;
+    m_bufferImageGranularity = properties.limits.bufferImageGranularity;
+    m_memoryBudget = memoryBudget;
+    m_heaps.assign(m_memoryProperties.memoryHeapCount, HeapState{});
+
+    updateBudget();
+
+    return true;
+}
+
+
+void MemoryAllocator::destroy() noexcept
+{
+    if(const Stats stats = getStats(); stats.allocationCount)
+        printf("memory allocator destroyed with %u live allocations\n", stats.allocationCount);
+
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& block : m_blocks)
+        freeMemory(block.memory, block.size, block.memoryType);
+
+    m_blocks.clear();
+    m_dedicatedCount = 0;
+    m_dedicatedBytes = 0;
+    m_fallbackCount = 0;
+}
+
+
+VkResult MemoryAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, Allocation& allocation) noexcept
+{
+    const VkBufferCreateInfo bufferInfo = 
+    {
+        .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext                 = nullptr,
+        .flags                 = 0,
+        .size                  = size,
+        .usage                 = usage,
+        .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices   = nullptr
+    };
+
+    if (auto result = vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer); result != VK_SUCCESS)
+        return result;
+
+    const VkBufferMemoryRequirementsInfo2 requirementsInfo = 
+    {
+        .sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+        .pNext  = nullptr,
+        .buffer = buffer
+    };
+
+    VkMemoryDedicatedRequirements dedicatedRequirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+    VkMemoryRequirements2 requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2, .pNext = &dedicatedRequirements };
+    vkGetBufferMemoryRequirements2(m_device, &requirementsInfo, &requirements);
+
+    const VkMemoryDedicatedAllocateInfo dedicatedInfo = 
+    {
+        .sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .pNext  = nullptr,
+        .image  = nullptr,
+        .buffer = buffer
+    };
+
+    const bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    VkResult result = allocate(requirements.memoryRequirements, properties, ResourceKind::Linear, dedicated, &dedicatedInfo, allocation);
+
+    if (result == VK_SUCCESS)
+        result = vkBindBufferMemory(m_device, buffer, allocation.memory, allocation.offset);
+
+    if (result != VK_SUCCESS)
+    {
+        destroyBuffer(buffer, allocation);
+        buffer = nullptr;
+    }
+
+    return result;
+}
+
+
+VkResult MemoryAllocator::createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, Allocation& allocation) noexcept
+{
+    if (auto result = vkCreateImage(m_device, &imageInfo, nullptr, &image); result != VK_SUCCESS)
+        return result;
+
+    const VkImageMemoryRequirementsInfo2 requirementsInfo = 
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+        .pNext = nullptr,
+        .image = image
+    };
+
+    VkMemoryDedicatedRequirements dedicatedRequirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+    VkMemoryRequirements2 requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2, .pNext = &dedicatedRequirements };
+    vkGetImageMemoryRequirements2(m_device, &requirementsInfo, &requirements);
+
+    const VkMemoryDedicatedAllocateInfo dedicatedInfo = 
+    {
+        .sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .pNext  = nullptr,
+        .image  = image,
+        .buffer = nullptr
+    };
+
+    const ResourceKind kind = (imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL) ? ResourceKind::Optimal : ResourceKind::Linear;
+    const bool dedicated = dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation;
+    VkResult result = allocate(requirements.memoryRequirements, properties, kind, dedicated, &dedicatedInfo, allocation);
+
+    if (result == VK_SUCCESS)
+        result = vkBindImageMemory(m_device, image, allocation.memory, allocation.offset);
+
+    if (result != VK_SUCCESS)
+    {
+        destroyImage(image, allocation);
+        image = nullptr;
+    }
+
+    return result;
+}
+
+
+void MemoryAllocator::destroyBuffer(VkBuffer buffer, Allocation& allocation) noexcept
+{
+    if(buffer)
+        vkDestroyBuffer(m_device, buffer, nullptr);
+
+    free(allocation);
+}
+
+
+void MemoryAllocator::destroyImage(VkImage image, Allocation& allocation) noexcept
+{
+    if(image)
+        vkDestroyImage(m_device, image, nullptr);
+
+    free(allocation);
+}
+
+
+VkResult MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, Allocation& allocation) noexcept
+{
+    return allocate(requirements, properties, kind, dedicated, nullptr, allocation);
+}
+
+
+void MemoryAllocator::free(Allocation& allocation) noexcept
+{
+    if(!allocation.memory)
+        return;
+
+    std::lock_guard lock(m_mutex);
+
+    if(allocation.block == 0)
+    {
+        freeMemory(allocation.memory, allocation.size, allocation.memoryType);
+        --m_dedicatedCount;
+        m_dedicatedBytes -= allocation.size;
+    }
+    else if (auto block = std::find_if(m_blocks.begin(), m_blocks.end(), [&allocation](const Block& b) { return b.id == allocation.block; }); block != m_blocks.end())
+    {
+        block->nodeBytes      -= MIN_NODE_SIZE << allocation.order;
+        block->requestedBytes -= allocation.size;
+        --block->allocationCount;
+
+        freeNode(*block, allocation.offset, allocation.order);
+
+        if(block->allocationCount == 0)
+        {
+            freeMemory(block->memory, block->size, block->memoryType);
+            m_blocks.erase(block);
+        }
+    }
+
+    allocation = {};
+}
+
+
+void MemoryAllocator::updateBudget() noexcept
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+    VkPhysicalDeviceMemoryProperties2 properties = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2, .pNext = &budgetProperties };
+
+    if(m_memoryBudget)
+        vkGetPhysicalDeviceMemoryProperties2(m_GPU, &properties);
+
+    std::lock_guard lock(m_mutex);
+
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+    {
+        HeapState& state = m_heaps[heap];
+
+        if(m_memoryBudget)
+        {
+            state.budget         = budgetProperties.heapBudget[heap];
+            state.polledUsage    = budgetProperties.heapUsage[heap];
+            state.reservedAtPoll = state.reserved;
+        }
+        else
+        {// only what this allocator reserved is known
+            state.budget         = m_memoryProperties.memoryHeaps[heap].size / 100 * DEFAULT_BUDGET_PERCENT;
+            state.polledUsage    = 0;
+            state.reservedAtPoll = 0;
+        }
+    }
+}
+
+
+std::vector<MemoryAllocator::HeapBudget> MemoryAllocator::getHeapBudgets() const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    std::vector<HeapBudget> budgets(m_heaps.size());
+
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+        budgets[heap] = makeHeapBudget(heap);
+
+    return budgets;
+}
+
+
+VkDeviceSize MemoryAllocator::getExcessBytes() const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    VkDeviceSize excess = 0;
+
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+    {
+        const HeapBudget budget = makeHeapBudget(heap);
+        const VkDeviceSize pressure = budget.budget / 100 * PRESSURE_BUDGET_PERCENT;
+
+        if(budget.deviceLocal && budget.usage > pressure)
+            excess += budget.usage - pressure;
+    }
+
+    return excess;
+}
+
+
+VkDeviceSize MemoryAllocator::getHeadroom() const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    VkDeviceSize headroom = VK_WHOLE_SIZE;
+
+    for (uint32_t heap = 0; heap < m_heaps.size(); ++heap)
+    {
+        const HeapBudget budget = makeHeapBudget(heap);
+        const VkDeviceSize pressure = budget.budget / 100 * PRESSURE_BUDGET_PERCENT;
+
+        if(budget.deviceLocal)
+            headroom = std::min(headroom, (budget.usage < pressure) ? pressure - budget.usage : 0);
+    }
+
+    return (headroom == VK_WHOLE_SIZE) ? 0 : headroom;
+}
+
+
+MemoryAllocator::Stats MemoryAllocator::getStats() const noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    Stats stats;
+    stats.blockCount      = static_cast<uint32_t>(m_blocks.size());
+    stats.fallbackCount   = m_fallbackCount;
+    stats.dedicatedCount  = m_dedicatedCount;
+    stats.allocationCount = m_dedicatedCount;
+    stats.reservedBytes   = m_dedicatedBytes;
+    stats.usedBytes       = m_dedicatedBytes;
+
+    for (const auto& block : m_blocks)
+    {
+        VkDeviceSize largestFree = 0;
+
+        for (uint32_t order = 0; order <= block.maxOrder; ++order)
+            if(!block.freeLists[order].empty())
+                largestFree = MIN_NODE_SIZE << order;
+
+        stats.allocationCount += block.allocationCount;
+        stats.reservedBytes   += block.size;
+        stats.usedBytes       += block.requestedBytes;
+        stats.fragmentedBytes += (block.nodeBytes - block.requestedBytes) + (block.size - block.nodeBytes - largestFree);
+    }
+
+    return stats;
+}
+
+
+const VkPhysicalDeviceMemoryProperties& MemoryAllocator::getMemoryProperties() const noexcept
+{
+    return m_memoryProperties;
+}
+
+
+VkResult MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, Allocation& allocation) noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+//  with a granularity of one linear and optimal resources may be neighbours
+    if(m_bufferImageGranularity <= 1)
+        kind = ResourceKind::Linear;
+
+    VkResult result = allocateInTypes(requirements, properties, kind, dedicated, dedicatedInfo, true, allocation);
+
+    if(result == VK_ERROR_FEATURE_NOT_PRESENT)
+    {
+        printf("no memory type with properties 0x%x in type bits 0x%x\n", properties, requirements.memoryTypeBits);
+        return result;
+    }
+
+//  device-local heaps are full, the resource is slower to access from any other memory but still works
+    if(result != VK_SUCCESS && (properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+    {
+        if (result = allocateInTypes(requirements, properties & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, kind, dedicated, dedicatedInfo, true, allocation); result == VK_SUCCESS)
+            ++m_fallbackCount;
+    }
+
+//  the budget is a soft limit, the driver may still page other memory out to make room
+    if(result != VK_SUCCESS)
+        result = allocateInTypes(requirements, properties, kind, dedicated, dedicatedInfo, false, allocation);
+
+    return result;
+}
+
+
+VkResult MemoryAllocator::allocateInTypes(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, bool withinBudget, Allocation& allocation) noexcept
+{
+    VkResult result = VK_ERROR_FEATURE_NOT_PRESENT;
+
+    for (uint32_t type = 0; type < m_memoryProperties.memoryTypeCount; ++type)
+    {
+        if (!(requirements.memoryTypeBits & (1U << type)) || (m_memoryProperties.memoryTypes[type].propertyFlags & properties) != properties)
+            continue;
+
+        const VkDeviceSize blockSize = getBlockSize(type);
+
+        if(dedicated || requirements.size > blockSize / 2)
+        {
+            result = (withinBudget && !fitsBudget(type, requirements.size)) ? VK_ERROR_OUT_OF_DEVICE_MEMORY
+                                                                             : allocateDedicated(requirements, type, dedicatedInfo, allocation);
+        }
+        else
+        {
+            for (auto& block : m_blocks)
+                if(block.memoryType == type && block.kind == kind && allocateFromBlock(block, requirements, allocation))
+                    return VK_SUCCESS;
+
+            Block block = {};
+            block.memoryType = type;
+            block.kind       = kind;
+            block.size       = blockSize;
+
+            if(withinBudget && !fitsBudget(type, blockSize))
+                result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+            else if (result = allocateMemory(blockSize, type, nullptr, block.memory, block.mapped); result == VK_SUCCESS)
+            {
+                block.id = m_nextBlockId++;
+
+                while ((MIN_NODE_SIZE << block.maxOrder) < blockSize)
+                    ++block.maxOrder;
+
+                block.freeLists.resize(block.maxOrder + 1);
+                block.freeLists[block.maxOrder].push_back(0);
+
+                m_blocks.push_back(std::move(block));
+                allocateFromBlock(m_blocks.back(), requirements, allocation);
+            }
+        }
+
+//      a full heap is not fatal while another type with the same properties is left
+        if(result != VK_ERROR_OUT_OF_DEVICE_MEMORY && result != VK_ERROR_OUT_OF_HOST_MEMORY)
+            break;
+    }
+
+    return result;
+}
+
+
+VkResult MemoryAllocator::allocateMemory(VkDeviceSize size, uint32_t memoryType, const void* pNext, VkDeviceMemory& memory, void*& mapped) noexcept
+{
+    const VkMemoryAllocateInfo allocInfo = 
+    {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = pNext,
+        .allocationSize  = size,
+        .memoryTypeIndex = memoryType
+    };
+
+    if (auto result = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory); result != VK_SUCCESS)
+        return result;
+
+    mapped = nullptr;
+    m_heaps[m_memoryProperties.memoryTypes[memoryType].heapIndex].reserved += size;
+
+    if (m_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (auto result = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped); result != VK_SUCCESS)
+        {
+            freeMemory(memory, size, memoryType);
+            return result;
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+
+void MemoryAllocator::freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType) noexcept
+{
+    vkFreeMemory(m_device, memory, nullptr);
+    m_heaps[m_memoryProperties.memoryTypes[memoryType].heapIndex].reserved -= size;
+}
+
+
+bool MemoryAllocator::fitsBudget(uint32_t memoryType, VkDeviceSize size) const noexcept
+{
+    const HeapBudget budget = makeHeapBudget(m_memoryProperties.memoryTypes[memoryType].heapIndex);
+
+    return budget.usage + size <= budget.budget;
+}
+
+
+MemoryAllocator::HeapBudget MemoryAllocator::makeHeapBudget(uint32_t heap) const noexcept
+{
+    const HeapState& state = m_heaps[heap];
+
+//  usage reported by the driver lags behind, so what was reserved or freed since the poll is applied on top
+    const VkDeviceSize usage = state.polledUsage + state.reserved;
+
+    return HeapBudget
+    {
+        .size        = m_memoryProperties.memoryHeaps[heap].size,
+        .budget      = state.budget,
+        .usage       = (usage > state.reservedAtPoll) ? usage - state.reservedAtPoll : 0,
+        .reserved    = state.reserved,
+        .deviceLocal = (m_memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0
+    };
+}
+
+
+VkResult MemoryAllocator::allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryType, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, Allocation& allocation) noexcept
+{
+    VkDeviceMemory memory;
+    void* mapped;
+
+    if (auto result = allocateMemory(requirements.size, memoryType, dedicatedInfo, memory, mapped); result != VK_SUCCESS)
+        return result;
+
+    allocation.memory     = memory;
+    allocation.offset     = 0;
+    allocation.size       = requirements.size;
+    allocation.mapped     = mapped;
+    allocation.memoryType = memoryType;
+    allocation.block      = 0;
+    allocation.order      = 0;
+
+    ++m_dedicatedCount;
+    m_dedicatedBytes += requirements.size;
+
+    return VK_SUCCESS;
+}
+
+
+bool MemoryAllocator::allocateFromBlock(Block& block, const VkMemoryRequirements& requirements, Allocation& allocation) noexcept
+{
+//  nodes are aligned to their own size, so a node at least as large as the alignment is always aligned
+    const VkDeviceSize needed = std::max(requirements.size, requirements.alignment);
+
+    uint32_t order = 0;
+
+    while ((MIN_NODE_SIZE << order) < needed)
+        ++order;
+
+    if(order > block.maxOrder)
+        return false;
+
+    uint32_t available = order;
+
+    while (available <= block.maxOrder && block.freeLists[available].empty())
+        ++available;
+
+    if(available > block.maxOrder)
+        return false;
+
+    const VkDeviceSize offset = block.freeLists[available].back();
+    block.freeLists[available].pop_back();
+
+//  split down to the requested order, the upper halves stay free
+    while (available > order)
+    {
+        --available;
+        block.freeLists[available].push_back(offset + (MIN_NODE_SIZE << available));
+    }
+
+    block.nodeBytes      += MIN_NODE_SIZE << order;
+    block.requestedBytes += requirements.size;
+    ++block.allocationCount;
+
+    allocation.memory     = block.memory;
+    allocation.offset     = offset;
+    allocation.size       = requirements.size;
+    allocation.mapped     = block.mapped ? static_cast<uint8_t*>(block.mapped) + offset : nullptr;
+    allocation.memoryType = block.memoryType;
+    allocation.block      = block.id;
+    allocation.order      = order;
+
+    return true;
+}
+
+
+void MemoryAllocator::freeNode(Block& block, VkDeviceSize offset, uint32_t order) noexcept
+{
+    while (order < block.maxOrder)
+    {
+        auto& freeList = block.freeLists[order];
+        const VkDeviceSize buddy = offset ^ (MIN_NODE_SIZE << order);
+
+        auto it = std::find(freeList.begin(), freeList.end(), buddy);
+
+        if(it == freeList.end())
+            break;
+
+        *it = freeList.back();
+        freeList.pop_back();
+
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    block.freeLists[order].push_back(offset);
+}
+
+
+VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryType) const noexcept
+{
+//  small heaps, e.g. the 256 MiB BAR window, get smaller blocks so one block does not take a large share of them
+    const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[memoryType].heapIndex].size;
+
+    VkDeviceSize blockSize = BLOCK_SIZE;
+
+    while (blockSize > heapSize / 8 && blockSize > (1ULL << 20))
+        blockSize /= 2;
+
+    return blockSize;
+}
\ No newline at end of file
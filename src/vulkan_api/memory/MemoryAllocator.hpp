@@ -0,0 +1,146 @@
+#ifndef MEMORY_ALLOCATOR_HPP
+#define MEMORY_ALLOCATOR_HPP
+
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Sub-allocates device memory from large blocks, so resources do not cost a vkAllocateMemory each.
+// Every block belongs to one memory type and is split by a buddy allocator: an allocation takes the smallest power of two
+// node that fits its size and alignment, freed nodes merge with their buddy and empty blocks go back to the driver.
+// With a bufferImageGranularity above one, buffers and linear images never share a block with optimally tiled images.
+// Resources the driver wants dedicated memory for, and anything larger than half a block, get an allocation of their own.
+// New memory is only taken from a heap while it stays within the heap's budget. Device-local requests that do not fit
+// fall back to any other memory type the resource supports, and are only allowed over budget when nothing else is left.
+class MemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize BLOCK_SIZE    = 64ULL << 20;
+    static constexpr VkDeviceSize MIN_NODE_SIZE = 256;
+
+//  Without VK_EXT_memory_budget this share of each heap is assumed to be available to the process
+    static constexpr VkDeviceSize DEFAULT_BUDGET_PERCENT  = 80;
+
+//  Above this share of its budget a device-local heap is under pressure and resident resources should be evicted
+    static constexpr VkDeviceSize PRESSURE_BUDGET_PERCENT = 90;
+
+    enum class ResourceKind : uint32_t
+    {
+        Linear, // buffers and linearly tiled images
+        Optimal // optimally tiled images
+    };
+
+    struct Allocation
+    {
+        VkDeviceMemory memory     = nullptr;
+        VkDeviceSize   offset     = 0;
+        VkDeviceSize   size       = 0;
+        void*          mapped     = nullptr; // host-visible memory stays mapped for the lifetime of the allocation
+        uint32_t       memoryType = 0;
+        uint32_t       block      = 0;       // 0 - dedicated
+        uint32_t       order      = 0;
+    };
+
+    struct Stats
+    {
+        uint32_t     blockCount      = 0;
+        uint32_t     dedicatedCount  = 0;
+        uint32_t     allocationCount = 0;
+        VkDeviceSize reservedBytes   = 0; // every vkAllocateMemory, blocks and dedicated
+        VkDeviceSize usedBytes       = 0; // requested by resources
+        VkDeviceSize fragmentedBytes = 0; // padding inside nodes plus free bytes outside the largest free node of each block
+        uint32_t     fallbackCount   = 0; // device-local requests that were placed in other memory
+    };
+
+    struct HeapBudget
+    {
+        VkDeviceSize size        = 0;
+        VkDeviceSize budget      = 0; // what the process may use
+        VkDeviceSize usage       = 0; // process wide at the last poll plus what this allocator reserved since
+        VkDeviceSize reserved    = 0; // blocks and dedicated allocations of this allocator
+        bool         deviceLocal = false;
+    };
+
+    MemoryAllocator() noexcept;
+
+//  memoryBudget - VK_EXT_memory_budget is enabled on the device
+    bool create(VkPhysicalDevice GPU, VkDevice device, bool memoryBudget) noexcept;
+
+//  Every allocation must have been freed
+    void destroy() noexcept;
+
+    VkResult createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, Allocation& allocation) noexcept;
+    VkResult createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, Allocation& allocation) noexcept;
+    void destroyBuffer(VkBuffer buffer, Allocation& allocation) noexcept;
+    void destroyImage(VkImage image, Allocation& allocation) noexcept;
+
+//  For resources created elsewhere, the caller binds the memory
+    VkResult allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, Allocation& allocation) noexcept;
+    void free(Allocation& allocation) noexcept;
+
+//  Once per frame, queries the driver's budget and usage of every heap
+    void updateBudget() noexcept;
+
+    std::vector<HeapBudget> getHeapBudgets() const noexcept;
+
+//  Device-local bytes above the pressure mark, summed over the heaps
+    VkDeviceSize getExcessBytes() const noexcept;
+
+//  Device-local bytes that can still be reserved before the first heap reaches the pressure mark
+    VkDeviceSize getHeadroom() const noexcept;
+
+    Stats getStats() const noexcept;
+    const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const noexcept;
+
+private:
+    struct Block
+    {
+        uint32_t       id;
+        uint32_t       memoryType;
+        ResourceKind   kind;
+        VkDeviceMemory memory;
+        void*          mapped;
+        VkDeviceSize   size;
+        VkDeviceSize   nodeBytes;      // taken by allocated nodes
+        VkDeviceSize   requestedBytes; // of which the resources asked for
+        uint32_t       allocationCount;
+        uint32_t       maxOrder;
+        std::vector<std::vector<VkDeviceSize>> freeLists; // node offsets by order
+    };
+
+    struct HeapState
+    {
+        VkDeviceSize budget;
+        VkDeviceSize polledUsage;
+        VkDeviceSize reservedAtPoll;
+        VkDeviceSize reserved;
+    };
+
+    VkResult allocateMemory(VkDeviceSize size, uint32_t memoryType, const void* pNext, VkDeviceMemory& memory, void*& mapped) noexcept;
+    void freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType) noexcept;
+    bool fitsBudget(uint32_t memoryType, VkDeviceSize size) const noexcept;
+    HeapBudget makeHeapBudget(uint32_t heap) const noexcept;
+    VkResult allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryType, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, Allocation& allocation) noexcept;
+    bool allocateFromBlock(Block& block, const VkMemoryRequirements& requirements, Allocation& allocation) noexcept;
+    void freeNode(Block& block, VkDeviceSize offset, uint32_t order) noexcept;
+    VkDeviceSize getBlockSize(uint32_t memoryType) const noexcept;
+
+    VkResult allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, Allocation& allocation) noexcept;
+    VkResult allocateInTypes(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, bool dedicated, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, bool withinBudget, Allocation& allocation) noexcept;
+
+    VkPhysicalDevice                 m_GPU;
+    VkDevice                         m_device;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
+    VkDeviceSize                     m_bufferImageGranularity;
+    bool                             m_memoryBudget;
+    std::vector<HeapState>           m_heaps;
+    std::vector<Block>               m_blocks;
+    uint32_t                         m_nextBlockId;
+    uint32_t                         m_dedicatedCount;
+    VkDeviceSize                     m_dedicatedBytes;
+    uint32_t                         m_fallbackCount;
+    mutable std::mutex               m_mutex;
+};
+
+#endif // !MEMORY_ALLOCATOR_HPP
\ No newline at end of file
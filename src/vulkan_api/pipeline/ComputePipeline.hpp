@@ -0,0 +1,29 @@
+#ifndef COMPUTE_PIPELINE_HPP
+#define COMPUTE_PIPELINE_HPP
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/pipeline/stages/shader/ShaderStage.hpp"
+#include "vulkan_api/pipeline/stages/uniform/DescriptorSetLayout.hpp"
+#include "vulkan_api/pipeline/PipelineCache.hpp"
+
+
+class ComputePipeline
+{
+public:
+    ComputePipeline() noexcept;
+
+    VkResult create(PipelineCache& cache, const ShaderStage& shader, const DescriptorSetLayout& descriptors, uint32_t pushConstantSize) noexcept;
+    void destroy(VkDevice device) noexcept;
+
+    VkDescriptorSetLayout getDescriptorSetLayout() const noexcept;
+    VkPipelineLayout      getLayout() const noexcept;
+    VkPipeline            getHandle() const noexcept;
+
+private:
+    VkDescriptorSetLayout m_descriptorSetLayout;
+    VkPipelineLayout      m_layout;
+    VkPipeline            m_handle;
+};
+
+#endif // !COMPUTE_PIPELINE_HPP
\ No newline at end of file
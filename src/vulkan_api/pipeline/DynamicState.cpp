@@ -0,0 +1,89 @@
+#include "vulkan_api/pipeline/DynamicState.hpp"
+
+
+DynamicState::Tracker::Tracker(const DynamicState& state) noexcept:
+    m_state(&state),
+    m_current(),
+    m_valid(0)
+{
+
+}
+
+
+void DynamicState::Tracker::reset() noexcept
+{
+    m_valid = 0;
+}
+
+
+uint32_t DynamicState::Tracker::apply(VkCommandBuffer cmd, const Values& values) noexcept
+{
+    uint32_t calls = 0;
+
+    auto changed = [this, &calls](Field field, auto current, auto value) noexcept
+    {
+        if((m_valid & field) && current == value)
+            return false;
+
+        m_valid |= field;
+        ++calls;
+
+        return true;
+    };
+
+    if(changed(Topology, m_current.topology, values.topology))
+        vkCmdSetPrimitiveTopology(cmd, values.topology);
+
+    if(changed(PrimitiveRestart, m_current.primitiveRestart, values.primitiveRestart))
+        vkCmdSetPrimitiveRestartEnable(cmd, values.primitiveRestart);
+
+    if(changed(CullMode, m_current.cullMode, values.cullMode))
+        vkCmdSetCullMode(cmd, values.cullMode);
+
+    if(changed(DepthTest, m_current.depthTest, values.depthTest))
+        vkCmdSetDepthTestEnable(cmd, values.depthTest);
+
+    if(changed(DepthWrite, m_current.depthWrite, values.depthWrite))
+        vkCmdSetDepthWriteEnable(cmd, values.depthWrite);
+
+    if(changed(PolygonMode, m_current.polygonMode, values.polygonMode))
+        m_state->m_setPolygonMode(cmd, values.polygonMode);
+
+//  one color attachment
+    if(changed(Blend, m_current.blend, values.blend))
+        m_state->m_setColorBlendEnable(cmd, 0, 1, &values.blend);
+
+    m_current = values;
+
+    return calls;
+}
+
+
+
+DynamicState::DynamicState() noexcept:
+    m_setPolygonMode(nullptr),
+    m_setColorBlendEnable(nullptr)
+{
+
+}
+
+
+bool DynamicState::create(VkDevice device) noexcept
+{
+    m_setPolygonMode      = reinterpret_cast<PFN_vkCmdSetPolygonModeEXT>(vkGetDeviceProcAddr(device, "vkCmdSetPolygonModeEXT"));
+    m_setColorBlendEnable = reinterpret_cast<PFN_vkCmdSetColorBlendEnableEXT>(vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEnableEXT"));
+
+    if(isEnabled())
+        return true;
+
+    m_setPolygonMode      = nullptr;
+    m_setColorBlendEnable = nullptr;
+
+    return false;
+}
+
+
+bool DynamicState::isEnabled() const noexcept
+{
+    return m_setPolygonMode && m_setColorBlendEnable;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef DYNAMIC_STATE_HPP
+#define DYNAMIC_STATE_HPP
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+// Fixed-function state that is set in the command buffer instead of being baked into the pipeline.
+// Topology, cull mode, primitive restart and the depth test and write switches are extended dynamic state 1 and 2,
+// both core since Vulkan 1.3; polygon mode and color blend enable come from VK_EXT_extended_dynamic_state3.
+// Pipelines built with GraphicsPipeline::State::setupExtendedDynamicState(true) leave all of them to the command buffer,
+// so wireframe, culling and blending variants of a material are one pipeline.
+class DynamicState
+{
+public:
+    struct Values
+    {
+        VkPrimitiveTopology topology         = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkBool32            primitiveRestart = VK_FALSE;
+        VkPolygonMode       polygonMode      = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags     cullMode         = VK_CULL_MODE_NONE;
+        VkBool32            depthTest        = VK_TRUE;
+        VkBool32            depthWrite       = VK_TRUE;
+        VkBool32            blend            = VK_FALSE;
+    };
+
+//  Remembers what was last set in one command buffer and skips the calls that would not change anything.
+//  Dynamic state is undefined at the start of every command buffer, primary or secondary, so each needs its own tracker
+    class Tracker
+    {
+    public:
+        explicit Tracker(const DynamicState& state) noexcept;
+
+//      Everything is set again by the next apply()
+        void reset() noexcept;
+
+//      Returns the number of vkCmdSet* calls recorded
+        uint32_t apply(VkCommandBuffer cmd, const Values& values) noexcept;
+
+    private:
+        enum Field : uint32_t
+        {
+            Topology         = 1 << 0,
+            PrimitiveRestart = 1 << 1,
+            PolygonMode      = 1 << 2,
+            CullMode         = 1 << 3,
+            DepthTest        = 1 << 4,
+            DepthWrite       = 1 << 5,
+            Blend            = 1 << 6
+        };
+
+        const DynamicState* m_state;
+        Values              m_current;
+        uint32_t            m_valid; // Field bits set since the last reset
+    };
+
+    DynamicState() noexcept;
+
+//  Loads the VK_EXT_extended_dynamic_state3 entry points, the context must have enabled it (Features::extendedDynamicState)
+    bool create(VkDevice device) noexcept;
+
+    bool isEnabled() const noexcept;
+
+private:
+    PFN_vkCmdSetPolygonModeEXT      m_setPolygonMode;
+    PFN_vkCmdSetColorBlendEnableEXT m_setColorBlendEnable;
+};
+
+#endif // !DYNAMIC_STATE_HPP
\ No newline at end of file
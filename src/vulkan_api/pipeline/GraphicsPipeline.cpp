@@ -9,7 +9,7 @@
 
 struct GraphicsPipelineStages
 {
-    std::vector<VkPipelineShaderStageCreateInfo> shaders;
+    std::vector<ShaderStage>                     shaders; // copies share the modules and their specialization
     std::unique_ptr<VertexInputState>            vertexInputState;
     VkPipelineInputAssemblyStateCreateInfo       inputAssembly;
     VkPipelineViewportStateCreateInfo            viewportState;
@@ -17,9 +17,39 @@ struct GraphicsPipelineStages
     VkPipelineMultisampleStateCreateInfo         multisampling;
     VkPipelineColorBlendAttachmentState          colorBlending;
     DescriptorSetLayout                          layoutInfo;
+    VkDescriptorSetLayout                        textureTable     = nullptr;
+    uint32_t                                     pushConstantSize = sizeof(mat4s);
+    bool                                         extendedDynamicState = false;
 };
 
 
+namespace
+{
+//  With dynamic topology a pipeline may only be drawn with topologies of the class it was built with
+    uint32_t get_topology_class(VkPrimitiveTopology topology) noexcept
+    {
+        switch (topology)
+        {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+                return 0;
+
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+                return 1;
+
+            case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+                return 3;
+
+            default:
+                return 2;
+        }
+    }
+}
+
+
+
 GraphicsPipeline::State* GraphicsPipeline::State::setupShaderStages(std::span<const ShaderStage> shaders) noexcept
 {
     if(!m_data)
@@ -29,8 +59,33 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupShaderStages(std::span<co
 
     if(!shaders.empty())
     {
-        for(const auto shader : shaders)
-            stages->shaders.push_back(shader.getInfo());
+        for(const auto& shader : shaders)
+            stages->shaders.push_back(shader);
+    }
+
+    return this;
+}
+
+
+GraphicsPipeline::State* GraphicsPipeline::State::setupSpecialization(VkShaderStageFlagBits stage, const SpecializationConstants& constants) noexcept
+{
+    if(!m_data)
+        m_data = std::make_shared<GraphicsPipelineStages>();
+
+    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
+
+    for(auto& shader : stages->shaders)
+    {
+        if(shader.getStage() != stage)
+            continue;
+
+        SpecializationConstants merged;
+
+        if(const auto current = shader.getSpecialization())
+            merged = *current;
+
+        merged.merge(constants);
+        shader.setSpecialization(merged);
     }
 
     return this;
@@ -179,6 +234,121 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupDescriptorSetLayout(const
 }
 
 
+GraphicsPipeline::State* GraphicsPipeline::State::setupTextureTable(VkDescriptorSetLayout textureTable) noexcept
+{
+    if(!m_data)
+        m_data = std::make_shared<GraphicsPipelineStages>();
+
+    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
+
+    stages->textureTable = textureTable;
+    
+    return this;
+}
+
+
+GraphicsPipeline::State* GraphicsPipeline::State::setupPushConstants(uint32_t size) noexcept
+{
+    if(!m_data)
+        m_data = std::make_shared<GraphicsPipelineStages>();
+
+    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
+
+    stages->pushConstantSize = size;
+    
+    return this;
+}
+
+
+GraphicsPipeline::State* GraphicsPipeline::State::setupExtendedDynamicState(bool enabled) noexcept
+{
+    if(!m_data)
+        m_data = std::make_shared<GraphicsPipelineStages>();
+
+    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
+
+    stages->extendedDynamicState = enabled;
+    
+    return this;
+}
+
+
+PipelineKey GraphicsPipeline::State::getKey(const MainView& view) const noexcept
+{
+    PipelineKey key;
+    auto stages = static_cast<const GraphicsPipelineStages*>(m_data.get());
+
+    if(!stages || !stages->vertexInputState)
+        return key;
+
+    key.add(view.getFormat()).add(vk::findDepthFormat(view.getContext()->getPhysicalDevice()));
+
+//  modules by handle, specialization constants by value
+    key.add(stages->shaders.size());
+
+    for (const auto& shader : stages->shaders)
+    {
+        const VkPipelineShaderStageCreateInfo info = shader.getInfo();
+        key.add(info.stage).add(info.module).add(std::string_view(info.pName));
+
+        const SpecializationConstants* specialization = shader.getSpecialization();
+        key.add(specialization != nullptr);
+
+        if(specialization)
+            key.add(*specialization);
+    }
+
+    const auto vertexInput = stages->vertexInputState->getinfo();
+    key.add(vertexInput.vertexBindingDescriptionCount).add(vertexInput.vertexAttributeDescriptionCount);
+
+    for (uint32_t i = 0; i < vertexInput.vertexBindingDescriptionCount; ++i)
+    {
+        const auto& binding = vertexInput.pVertexBindingDescriptions[i];
+        key.add(binding.binding).add(binding.stride).add(binding.inputRate);
+    }
+
+    for (uint32_t i = 0; i < vertexInput.vertexAttributeDescriptionCount; ++i)
+    {
+        const auto& attribute = vertexInput.pVertexAttributeDescriptions[i];
+        key.add(attribute.location).add(attribute.binding).add(attribute.format).add(attribute.offset);
+    }
+
+    const auto& rasterizer = stages->rasterizer;
+    const auto& blending   = stages->colorBlending;
+
+//  dynamic values are left out, states that only differ in them share a pipeline
+    key.add(stages->extendedDynamicState);
+
+    if(stages->extendedDynamicState)
+        key.add(get_topology_class(stages->inputAssembly.topology));
+    else
+        key.add(stages->inputAssembly.topology).add(stages->inputAssembly.primitiveRestartEnable)
+           .add(rasterizer.polygonMode).add(rasterizer.cullMode).add(blending.blendEnable);
+
+    key.add(stages->viewportState.viewportCount).add(stages->viewportState.scissorCount)
+       .add(rasterizer.depthClampEnable).add(rasterizer.rasterizerDiscardEnable).add(rasterizer.frontFace)
+       .add(rasterizer.depthBiasEnable).add(rasterizer.depthBiasConstantFactor).add(rasterizer.depthBiasClamp).add(rasterizer.depthBiasSlopeFactor).add(rasterizer.lineWidth)
+       .add(stages->multisampling.rasterizationSamples).add(stages->multisampling.sampleShadingEnable).add(stages->multisampling.minSampleShading)
+       .add(stages->multisampling.alphaToCoverageEnable).add(stages->multisampling.alphaToOneEnable)
+       .add(blending.srcColorBlendFactor).add(blending.dstColorBlendFactor).add(blending.colorBlendOp)
+       .add(blending.srcAlphaBlendFactor).add(blending.dstAlphaBlendFactor).add(blending.alphaBlendOp).add(blending.colorWriteMask);
+
+//  the layout, the same way the registry keys it
+    const VkDescriptorSetLayoutCreateInfo layoutInfo = stages->layoutInfo.getInfo();
+    key.add(layoutInfo.bindingCount);
+
+    for (uint32_t i = 0; i < layoutInfo.bindingCount; ++i)
+    {
+        const auto& binding = layoutInfo.pBindings[i];
+        key.add(binding.binding).add(binding.descriptorType).add(binding.descriptorCount).add(binding.stageFlags);
+    }
+
+    key.add(stages->textureTable).add(stages->pushConstantSize);
+
+    return key;
+}
+
+
 
 GraphicsPipeline::GraphicsPipeline() noexcept:
     m_descriptorSetLayout(nullptr),
@@ -214,7 +384,11 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .stencilAttachmentFormat = VK_FORMAT_UNDEFINED
     };
 
-    const auto& shaderStages  = stages->shaders;
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+
+    for(const auto& shader : stages->shaders)
+        shaderStages.push_back(shader.getInfo());
+
     const auto vertexInput    = stages->vertexInputState->getinfo();
     const auto& inputAssembly = stages->inputAssembly;
     const auto& viewportState = stages->viewportState;
@@ -232,10 +406,18 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .pAttachments    = &stages->colorBlending
     };
 
-    std::array<VkDynamicState, 2> dynamicStates = 
+//  the first two are always dynamic, the rest only with extended dynamic state
+    std::array<VkDynamicState, 9> dynamicStates = 
     {
         VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
+        VK_DYNAMIC_STATE_SCISSOR,
+        VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+        VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE,
+        VK_DYNAMIC_STATE_CULL_MODE,
+        VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+        VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+        VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+        VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT
     };
 
     VkPipelineDynamicStateCreateInfo dynamicState = 
@@ -243,33 +425,29 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
         .pNext             = nullptr,
         .flags             = 0,
-        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .dynamicStateCount = stages->extendedDynamicState ? static_cast<uint32_t>(dynamicStates.size()) : 2U,
         .pDynamicStates    = dynamicStates.data()
     };
 
-    const VkDescriptorSetLayoutCreateInfo layoutInfo = stages->layoutInfo.getInfo();
+//  equal layouts are shared with every other pipeline, so descriptor sets bound for one fit all of them
+    auto& registry = view.getContext()->getPipelineRegistry();
 
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
-        return VK_ERROR_INITIALIZATION_FAILED;
+    m_descriptorSetLayout = registry.getDescriptorSetLayout(stages->layoutInfo);
 
+    if (!m_descriptorSetLayout)
+        return VK_ERROR_INITIALIZATION_FAILED;
 
     VkPushConstantRange pushConstantRange = {};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; 
     pushConstantRange.offset = 0; 
-    pushConstantRange.size = sizeof(mat4s);
+    pushConstantRange.size = stages->pushConstantSize;
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = 
-    {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .pNext                  = nullptr,
-        .flags                  = 0,
-        .setLayoutCount         = 1,
-        .pSetLayouts            = &m_descriptorSetLayout,
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &pushConstantRange
-    };
+//  set 0 belongs to the pipeline, the shared texture table follows as set 1
+    const std::array<VkDescriptorSetLayout, 2> setLayouts = { m_descriptorSetLayout, stages->textureTable };
 
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+    m_layout = registry.getPipelineLayout(std::span(setLayouts.data(), stages->textureTable ? 2U : 1U), std::span(&pushConstantRange, 1));
+
+    if (!m_layout)
         return VK_ERROR_INITIALIZATION_FAILED;
 
     VkPipelineDepthStencilStateCreateInfo depthStencil = 
@@ -311,22 +489,19 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .basePipelineIndex   = 0
     };
 
-    return vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_handle);
+    return view.getContext()->getPipelineCache().createGraphicsPipeline(pipelineInfo, m_handle);
 }
 
 
 void GraphicsPipeline::destroy(VkDevice device) noexcept
 {
     if(m_handle)
-    {
         vkDestroyPipeline(device, m_handle, nullptr);
-        vkDestroyPipelineLayout(device, m_layout, nullptr);
-        vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, nullptr);
 
-        m_handle = nullptr;
-        m_layout = nullptr;
-        m_descriptorSetLayout = nullptr;
-    }
+//  the layouts belong to the registry
+    m_handle = nullptr;
+    m_layout = nullptr;
+    m_descriptorSetLayout = nullptr;
 }
 
 
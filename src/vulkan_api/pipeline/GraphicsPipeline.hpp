@@ -6,6 +6,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_api/pipeline/PipelineKey.hpp"
 #include "vulkan_api/pipeline/stages/shader/ShaderStage.hpp"
 #include "vulkan_api/pipeline/stages/vertex/VertexInputState.hpp"
 #include "vulkan_api/pipeline/stages/uniform/DescriptorSetLayout.hpp"
@@ -17,6 +18,7 @@ public:
     struct State
     {
         State* setupShaderStages(std::span<const ShaderStage> shaders)                   noexcept;
+        State* setupSpecialization(VkShaderStageFlagBits stage, const SpecializationConstants& constants) noexcept; // merged over the stage's own
         State* setupVertexInput(std::span<const VertexInputState::Attribute> attributes) noexcept;
         State* setupInputAssembler(const VkPrimitiveTopology primitive)                  noexcept;
         State* setupViewport()                                                           noexcept;
@@ -24,6 +26,16 @@ public:
         State* setupMultisampling()                                                      noexcept;
         State* setupColorBlending(VkBool32 enabled)                                      noexcept;
         State* setupDescriptorSetLayout(const DescriptorSetLayout& uniformDescriptorSet) noexcept;
+        State* setupTextureTable(VkDescriptorSetLayout textureTable)                     noexcept;
+        State* setupPushConstants(uint32_t size)                                         noexcept;
+
+//      Topology (within its class), primitive restart, polygon mode, cull mode, depth test and write and blend enable
+//      are left to the command buffer, see DynamicState. Requires VulkanContext::Features::extendedDynamicState
+        State* setupExtendedDynamicState(bool enabled)                                   noexcept;
+
+//      Everything the pipeline would be built from, including the attachment formats of view.
+//      Empty when the state has not been set up
+        PipelineKey getKey(const class MainView& view) const noexcept;
 
     private:
         std::shared_ptr<void> m_data;
@@ -32,6 +44,7 @@ public:
 
     GraphicsPipeline() noexcept;
 
+//  The layouts come from the context's PipelineRegistry, which owns them, only the pipeline itself belongs to this object
     VkResult create(const class MainView& view, const State& state) noexcept;
     void destroy(VkDevice device) noexcept;
 
@@ -0,0 +1,265 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "utils/AssetArchive.hpp"
+#include "utils/Trace.hpp"
+#include "vulkan_api/pipeline/PipelineCache.hpp"
+
+
+namespace
+{
+    constexpr uint32_t CACHE_FILE_MAGIC = 0x43504356; // "VCPC"
+
+//  Written in front of the driver's blob. The blob carries no checksum of its own and drivers differ in how well they survive a damaged one
+    struct CacheFileHeader
+    {
+        uint32_t magic;
+        uint32_t driverVersion; // a driver update may keep the UUID but still reject or misread old entries
+        uint64_t dataSize;
+        uint64_t hash;
+    };
+
+    static_assert(sizeof(CacheFileHeader) == 24, "the cache file header is read in place");
+
+
+    uint64_t elapsed_since(std::chrono::steady_clock::time_point start) noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+
+
+PipelineCache::PipelineCache() noexcept:
+    m_device(nullptr),
+    m_handle(nullptr),
+    m_properties(),
+    m_loadedBytes(0),
+    m_pipelineCount(0),
+    m_creationTime(0)
+{
+
+}
+
+
+bool PipelineCache::create(VkPhysicalDevice GPU, VkDevice device, const std::filesystem::path& path) noexcept
+{
+    TRACE_SCOPE("PipelineCache::create");
+
+    m_device = device;
+    m_path   = path;
+    vkGetPhysicalDeviceProperties(GPU, &m_properties);
+
+    std::vector<uint8_t> blob;
+    m_loadedBytes = load(blob) ? blob.size() : 0;
+
+    const VkPipelineCacheCreateInfo cacheInfo = 
+    {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext           = nullptr,
+        .flags           = 0,
+        .initialDataSize = static_cast<size_t>(m_loadedBytes),
+        .pInitialData    = m_loadedBytes ? blob.data() : nullptr
+    };
+
+    if(vkCreatePipelineCache(device, &cacheInfo, nullptr, &m_handle) == VK_SUCCESS)
+        return true;
+
+//  the driver may still refuse data that passed every check, an empty cache is better than none
+    m_loadedBytes = 0;
+
+    const VkPipelineCacheCreateInfo emptyInfo = 
+    {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext           = nullptr,
+        .flags           = 0,
+        .initialDataSize = 0,
+        .pInitialData    = nullptr
+    };
+
+    if(vkCreatePipelineCache(device, &emptyInfo, nullptr, &m_handle) == VK_SUCCESS)
+        return true;
+
+    m_handle = nullptr;
+
+    return false;
+}
+
+
+bool PipelineCache::save() const noexcept
+{
+    TRACE_SCOPE("PipelineCache::save");
+
+    if(!m_handle)
+        return false;
+
+    size_t size = 0;
+
+    if(vkGetPipelineCacheData(m_device, m_handle, &size, nullptr) != VK_SUCCESS || size == 0)
+        return false;
+
+    std::vector<uint8_t> blob(size);
+
+    if(vkGetPipelineCacheData(m_device, m_handle, &size, blob.data()) != VK_SUCCESS)
+        return false;
+
+    blob.resize(size);
+
+    const CacheFileHeader header = 
+    {
+        .magic         = CACHE_FILE_MAGIC,
+        .driverVersion = m_properties.driverVersion,
+        .dataSize      = blob.size(),
+        .hash          = AssetArchive::hash(blob)
+    };
+
+    std::filesystem::path temporary = m_path;
+    temporary += ".tmp";
+
+    std::error_code error;
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+
+    if(!stream.is_open())
+    {
+        printf("failed to create %s\n", temporary.string().c_str());
+        return false;
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    stream.close();
+
+    if(!stream)
+    {
+        printf("failed to write %s\n", temporary.string().c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    std::filesystem::rename(temporary, m_path, error);
+
+    if(error)
+    {
+        printf("failed to replace %s: %s\n", m_path.string().c_str(), error.message().c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+
+void PipelineCache::destroy() noexcept
+{
+    if(m_handle)
+        vkDestroyPipelineCache(m_device, m_handle, nullptr);
+
+    m_handle = nullptr;
+}
+
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& info, VkPipeline& pipeline) noexcept
+{
+    const auto start = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateGraphicsPipelines(m_device, m_handle, 1, &info, nullptr, &pipeline);
+    addCreation(elapsed_since(start));
+
+    return result;
+}
+
+
+VkResult PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& info, VkPipeline& pipeline) noexcept
+{
+    const auto start = std::chrono::steady_clock::now();
+    const VkResult result = vkCreateComputePipelines(m_device, m_handle, 1, &info, nullptr, &pipeline);
+    addCreation(elapsed_since(start));
+
+    return result;
+}
+
+
+VkPipelineCache PipelineCache::getHandle() const noexcept
+{
+    return m_handle;
+}
+
+
+VkDevice PipelineCache::getDevice() const noexcept
+{
+    return m_device;
+}
+
+
+PipelineCache::Stats PipelineCache::getStats() const noexcept
+{
+    return Stats
+    {
+        .warm          = m_loadedBytes != 0,
+        .loadedBytes   = m_loadedBytes,
+        .pipelineCount = m_pipelineCount,
+        .creationTime  = static_cast<double>(m_creationTime) / 1e6
+    };
+}
+
+
+bool PipelineCache::load(std::vector<uint8_t>& blob) const noexcept
+{
+    std::ifstream stream(m_path, std::ios::ate | std::ios::binary);
+
+    if(!stream.is_open())
+        return false; // first run
+
+    const size_t fileSize = static_cast<size_t>(stream.tellg());
+    CacheFileHeader header = {};
+    VkPipelineCacheHeaderVersionOne cacheHeader = {};
+
+    if(fileSize < sizeof(header) + sizeof(cacheHeader))
+    {
+        printf("pipeline cache %s is truncated, starting cold\n", m_path.string().c_str());
+        return false;
+    }
+
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if(header.magic != CACHE_FILE_MAGIC || header.dataSize != fileSize - sizeof(header))
+    {
+        printf("pipeline cache %s is not a cache file or is truncated, starting cold\n", m_path.string().c_str());
+        return false;
+    }
+
+    blob.resize(static_cast<size_t>(header.dataSize));
+    stream.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+
+    if(!stream || AssetArchive::hash(blob) != header.hash)
+    {
+        printf("pipeline cache %s is damaged, starting cold\n", m_path.string().c_str());
+        return false;
+    }
+
+    memcpy(&cacheHeader, blob.data(), sizeof(cacheHeader));
+
+    const bool sameDevice = cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                         && cacheHeader.headerSize >= sizeof(cacheHeader)
+                         && cacheHeader.vendorID == m_properties.vendorID
+                         && cacheHeader.deviceID == m_properties.deviceID
+                         && memcmp(cacheHeader.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0
+                         && header.driverVersion == m_properties.driverVersion;
+
+    if(!sameDevice)
+    {
+        printf("pipeline cache %s was written for another device or driver, starting cold\n", m_path.string().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+void PipelineCache::addCreation(uint64_t nanoseconds) noexcept
+{
+    ++m_pipelineCount;
+    m_creationTime += nanoseconds;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef PIPELINE_CACHE_HPP
+#define PIPELINE_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// One VkPipelineCache shared by every pipeline the context creates, kept on disk between runs.
+// The blob is only handed to the driver when it was written by the same driver for the same device, a stale or damaged file
+// starts an empty cache. Saving writes a temporary file next to the target and renames it, so a crash never leaves half a cache behind.
+class PipelineCache
+{
+public:
+    static constexpr const char* DEFAULT_PATH = "pipeline_cache.bin";
+
+    struct Stats
+    {
+        bool     warm;          // a blob from a previous run was accepted
+        uint64_t loadedBytes;
+        uint32_t pipelineCount; // created through this cache since create()
+        double   creationTime;  // milliseconds spent in vkCreate*Pipelines
+    };
+
+    PipelineCache() noexcept;
+
+//  Only fails when no cache object could be created, a missing or rejected file gives an empty one
+    bool create(VkPhysicalDevice GPU, VkDevice device, const std::filesystem::path& path) noexcept;
+
+//  Writes the current contents to the path given to create()
+    bool save() const noexcept;
+    void destroy() noexcept;
+
+//  May be called from any thread, the driver synchronizes access to the cache
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& info, VkPipeline& pipeline) noexcept;
+    VkResult createComputePipeline(const VkComputePipelineCreateInfo& info, VkPipeline& pipeline) noexcept;
+
+    VkPipelineCache getHandle() const noexcept;
+    VkDevice        getDevice() const noexcept;
+    Stats           getStats()  const noexcept;
+
+private:
+    bool load(std::vector<uint8_t>& blob) const noexcept;
+    void addCreation(uint64_t nanoseconds) noexcept;
+
+    VkDevice                   m_device;
+    VkPipelineCache            m_handle;
+    VkPhysicalDeviceProperties m_properties;
+    std::filesystem::path      m_path;
+    uint64_t                   m_loadedBytes;
+    std::atomic<uint32_t>      m_pipelineCount;
+    std::atomic<uint64_t>      m_creationTime; // nanoseconds
+};
+
+#endif // !PIPELINE_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <cstdio>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/pipeline/PipelineCompiler.hpp"
+
+
+PipelineCompiler::Status PipelineCompiler::Handle::getStatus() const noexcept
+{
+    return m_job ? m_job->status.load() : Status::Failed;
+}
+
+
+bool PipelineCompiler::Handle::isValid() const noexcept
+{
+    return m_job != nullptr;
+}
+
+
+bool PipelineCompiler::Handle::isReady() const noexcept
+{
+    return getStatus() == Status::Ready;
+}
+
+
+const GraphicsPipeline* PipelineCompiler::Handle::get() const noexcept
+{
+    return isReady() ? m_job->pipeline.get() : nullptr;
+}
+
+
+const GraphicsPipeline* PipelineCompiler::Handle::wait() const noexcept
+{
+    if(!m_job)
+        return nullptr;
+
+    m_job->status.wait(Status::Pending);
+
+    return get();
+}
+
+
+
+PipelineCompiler::PipelineCompiler() noexcept:
+    m_pending(0),
+    m_cancelled(false)
+{
+
+}
+
+
+bool PipelineCompiler::create(uint32_t threadCount) noexcept
+{
+    m_cancelled = false;
+    m_workers = std::make_unique<ThreadPool>(threadCount);
+
+    return true;
+}
+
+
+void PipelineCompiler::destroy() noexcept
+{
+    m_cancelled = true;
+    m_workers.reset();
+}
+
+
+PipelineCompiler::Handle PipelineCompiler::compile(const MainView& view, const GraphicsPipeline::State& state) noexcept
+{
+    Handle handle;
+
+    if(!m_workers)
+        return handle;
+
+    handle.m_job = std::make_shared<Job>();
+
+//  a state that was built before needs no worker, the handle is ready right away
+    if(auto pipeline = view.getContext()->getPipelineRegistry().findGraphicsPipeline(view, state))
+    {
+        handle.m_job->pipeline = std::move(pipeline);
+        handle.m_job->status   = Status::Ready;
+
+        return handle;
+    }
+
+    ++m_pending;
+
+//  the state is shared, not copied, its stages stay alive with the task
+    m_workers->submit([this, job = handle.m_job, &view, state](uint32_t)
+    {
+        Status status = Status::Failed;
+
+        if(!m_cancelled)
+        {
+            TRACE_SCOPE("PipelineCompiler::compile");
+
+            job->pipeline = view.getContext()->getPipelineRegistry().getGraphicsPipeline(view, state);
+
+            if(job->pipeline)
+                status = Status::Ready;
+            else
+                printf("failed to compile a pipeline in the background\n");
+        }
+
+        --m_pending;
+        job->status = status;
+        job->status.notify_all();
+    });
+
+    return handle;
+}
+
+
+uint32_t PipelineCompiler::getPendingCount() const noexcept
+{
+    return m_pending;
+}
\ No newline at end of file
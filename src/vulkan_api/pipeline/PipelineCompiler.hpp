@@ -0,0 +1,73 @@
+#ifndef PIPELINE_COMPILER_HPP
+#define PIPELINE_COMPILER_HPP
+
+#include <atomic>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include "utils/ThreadPool.hpp"
+#include "vulkan_api/pipeline/GraphicsPipeline.hpp"
+
+// Builds graphics pipelines on worker threads so a new pipeline never stalls the frame that asked for it.
+// compile() returns right away with a handle the render loop polls every frame; until the handle is ready
+// the renderer keeps drawing with a pipeline it already has, or skips the draw.
+// Pipelines are looked up in the context's PipelineRegistry, a state that was built before is ready right away,
+// and new ones go through the context's pipeline cache, which the driver synchronizes.
+class PipelineCompiler
+{
+public:
+    enum class Status : uint32_t
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+private:
+    struct Job
+    {
+        std::shared_ptr<const GraphicsPipeline> pipeline; // owned by the registry
+        std::atomic<Status> status = Status::Pending;
+    };
+
+public:
+    class Handle
+    {
+    public:
+        Status getStatus() const noexcept;
+        bool   isValid()   const noexcept; // returned by compile(), not default constructed
+        bool   isReady()   const noexcept;
+
+//      nullptr until the pipeline is ready, never blocks
+        const GraphicsPipeline* get() const noexcept;
+
+//      Blocks until the compile finished, nullptr when it failed
+        const GraphicsPipeline* wait() const noexcept;
+
+    private:
+        std::shared_ptr<Job> m_job;
+        friend class PipelineCompiler;
+    };
+
+    PipelineCompiler() noexcept;
+
+    bool create(uint32_t threadCount) noexcept;
+
+//  Compiles that have not started are dropped, running ones finish first.
+//  The pipelines stay in the registry, they are destroyed with the context
+    void destroy() noexcept;
+
+//  view and the shader modules referenced by state must stay alive, and state unchanged, until the handle is no longer pending
+    Handle compile(const class MainView& view, const GraphicsPipeline::State& state) noexcept;
+
+    uint32_t getPendingCount() const noexcept;
+
+private:
+//  a job is owned by its handle and its queued task, whichever lets go last frees it
+    std::unique_ptr<ThreadPool> m_workers;
+    std::atomic<uint32_t>       m_pending;
+    std::atomic<bool>           m_cancelled;
+};
+
+#endif // !PIPELINE_COMPILER_HPP
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "vulkan_api/pipeline/PipelineKey.hpp"
+
+
+size_t PipelineKey::Hasher::operator()(const PipelineKey& key) const noexcept
+{
+    return key.hash();
+}
+
+
+
+PipelineKey::PipelineKey() noexcept:
+    m_hash(0xcbf29ce484222325ULL)
+{
+
+}
+
+
+PipelineKey& PipelineKey::add(float value) noexcept
+{
+    return push(std::bit_cast<uint32_t>(value));
+}
+
+
+PipelineKey& PipelineKey::add(const void* handle) noexcept
+{
+    return push(reinterpret_cast<uintptr_t>(handle));
+}
+
+
+PipelineKey& PipelineKey::add(std::string_view text) noexcept
+{
+    push(text.size());
+
+    for (size_t offset = 0; offset < text.size(); offset += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, text.data() + offset, std::min(text.size() - offset, sizeof(uint64_t)));
+        push(word);
+    }
+
+    return *this;
+}
+
+
+PipelineKey& PipelineKey::add(const SpecializationConstants& constants) noexcept
+{
+    m_specializations.push_back(constants);
+
+    return push(constants.hash());
+}
+
+
+size_t PipelineKey::hash() const noexcept
+{
+    return m_hash;
+}
+
+
+size_t PipelineKey::size() const noexcept
+{
+    return m_words.size();
+}
+
+
+bool PipelineKey::operator == (const PipelineKey& other) const noexcept
+{
+    return m_hash == other.m_hash && m_words == other.m_words && m_specializations == other.m_specializations;
+}
+
+
+PipelineKey& PipelineKey::push(uint64_t word) noexcept
+{
+//  the hash follows the words as they are added, lookups never walk the key again
+    m_words.push_back(word);
+    m_hash = (m_hash ^ (word * 0x9e3779b97f4a7c15ULL)) * 0x100000001b3ULL;
+    m_hash ^= m_hash >> 29;
+
+    return *this;
+}
\ No newline at end of file
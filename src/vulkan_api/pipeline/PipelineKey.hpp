@@ -0,0 +1,51 @@
+#ifndef PIPELINE_KEY_HPP
+#define PIPELINE_KEY_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "vulkan_api/pipeline/stages/shader/SpecializationConstants.hpp"
+
+// A pipeline description flattened into a list of 64-bit words, field by field in a fixed order.
+// Two descriptions that would build the same Vulkan object give equal keys, so keys compare and hash by value
+// and can index a map. Handles are compared by identity: the same shader module, not the same SPIR-V.
+class PipelineKey
+{
+public:
+    struct Hasher
+    {
+        size_t operator()(const PipelineKey& key) const noexcept;
+    };
+
+    PipelineKey() noexcept;
+
+//  Integers, flags and enums
+    template<typename T> requires std::is_integral_v<T> || std::is_enum_v<T>
+    PipelineKey& add(T value) noexcept
+    {
+        return push(static_cast<uint64_t>(value));
+    }
+
+    PipelineKey& add(float value)           noexcept; // by its bits
+    PipelineKey& add(const void* handle)    noexcept;
+    PipelineKey& add(std::string_view text) noexcept; // length first, so neighbouring strings can not run into each other
+
+//  Hashed by SpecializationConstants::hash(), a copy is kept so equal hashes are confirmed by value
+    PipelineKey& add(const SpecializationConstants& constants) noexcept;
+
+    size_t hash()  const noexcept;
+    size_t size()  const noexcept;
+
+    bool operator == (const PipelineKey& other) const noexcept;
+
+private:
+    PipelineKey& push(uint64_t word) noexcept;
+
+    std::vector<uint64_t>                m_words;
+    std::vector<SpecializationConstants> m_specializations;
+    size_t                               m_hash;
+};
+
+#endif // !PIPELINE_KEY_HPP
\ No newline at end of file
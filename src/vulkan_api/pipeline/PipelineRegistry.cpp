@@ -0,0 +1,206 @@
+#include <cstdio>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/pipeline/PipelineRegistry.hpp"
+
+
+PipelineRegistry::PipelineRegistry() noexcept:
+    m_device(nullptr),
+    m_hits(0),
+    m_misses(0)
+{
+
+}
+
+
+void PipelineRegistry::create(VkDevice device) noexcept
+{
+    m_device = device;
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+
+void PipelineRegistry::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_pipelinesMutex);
+
+        for (auto& [key, pipeline] : m_pipelines)
+            pipeline->destroy(m_device);
+
+        m_pipelines.clear();
+    }
+
+    std::lock_guard lock(m_layoutsMutex);
+
+//  the layouts go last, the pipelines above were built on them
+    for (auto& [key, layout] : m_pipelineLayouts)
+        vkDestroyPipelineLayout(m_device, layout, nullptr);
+
+    for (auto& [key, layout] : m_descriptorSetLayouts)
+        vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+
+    m_pipelineLayouts.clear();
+    m_descriptorSetLayouts.clear();
+}
+
+
+std::shared_ptr<const GraphicsPipeline> PipelineRegistry::getGraphicsPipeline(const MainView& view, const GraphicsPipeline::State& state) noexcept
+{
+    PipelineKey key = state.getKey(view);
+
+    if(key.size() == 0)
+        return nullptr;
+
+    if(auto found = find(key))
+        return found;
+
+//  built without the lock, a compile on a worker thread must not hold up lookups of pipelines that already exist
+    auto pipeline = std::make_shared<GraphicsPipeline>();
+
+    {
+        TRACE_SCOPE("PipelineRegistry::build");
+
+        if(pipeline->create(view, state) != VK_SUCCESS)
+        {
+            pipeline->destroy(m_device);
+            return nullptr;
+        }
+    }
+
+    std::lock_guard lock(m_pipelinesMutex);
+
+    auto [found, inserted] = m_pipelines.try_emplace(std::move(key), pipeline);
+
+    if(inserted)
+        ++m_misses;
+    else
+    {
+        ++m_hits;
+        pipeline->destroy(m_device);
+    }
+
+    return found->second;
+}
+
+
+std::shared_ptr<const GraphicsPipeline> PipelineRegistry::findGraphicsPipeline(const MainView& view, const GraphicsPipeline::State& state) noexcept
+{
+    const PipelineKey key = state.getKey(view);
+
+    if(key.size() == 0)
+        return nullptr;
+
+    return find(key);
+}
+
+
+VkDescriptorSetLayout PipelineRegistry::getDescriptorSetLayout(const DescriptorSetLayout& layout) noexcept
+{
+    const VkDescriptorSetLayoutCreateInfo info = layout.getInfo();
+
+    PipelineKey key;
+    key.add(info.flags).add(info.bindingCount);
+
+    for (uint32_t i = 0; i < info.bindingCount; ++i)
+    {
+        const VkDescriptorSetLayoutBinding& binding = info.pBindings[i];
+        key.add(binding.binding).add(binding.descriptorType).add(binding.descriptorCount).add(binding.stageFlags).add(binding.pImmutableSamplers);
+    }
+
+    std::lock_guard lock(m_layoutsMutex);
+
+    if(auto found = m_descriptorSetLayouts.find(key); found != m_descriptorSetLayouts.end())
+        return found->second;
+
+    VkDescriptorSetLayout handle = nullptr;
+
+    if(vkCreateDescriptorSetLayout(m_device, &info, nullptr, &handle) != VK_SUCCESS)
+    {
+        printf("failed to create a descriptor set layout\n");
+        return nullptr;
+    }
+
+    m_descriptorSetLayouts.emplace(std::move(key), handle);
+
+    return handle;
+}
+
+
+VkPipelineLayout PipelineRegistry::getPipelineLayout(std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> pushConstants) noexcept
+{
+//  set layouts come from this registry, equal ones are the same handle
+    PipelineKey key;
+    key.add(setLayouts.size());
+
+    for (const auto setLayout : setLayouts)
+        key.add(setLayout);
+
+    key.add(pushConstants.size());
+
+    for (const auto& range : pushConstants)
+        key.add(range.stageFlags).add(range.offset).add(range.size);
+
+    std::lock_guard lock(m_layoutsMutex);
+
+    if(auto found = m_pipelineLayouts.find(key); found != m_pipelineLayouts.end())
+        return found->second;
+
+    const VkPipelineLayoutCreateInfo info =
+    {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext                  = nullptr,
+        .flags                  = 0,
+        .setLayoutCount         = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts            = setLayouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(pushConstants.size()),
+        .pPushConstantRanges    = pushConstants.data()
+    };
+
+    VkPipelineLayout handle = nullptr;
+
+    if(vkCreatePipelineLayout(m_device, &info, nullptr, &handle) != VK_SUCCESS)
+    {
+        printf("failed to create a pipeline layout\n");
+        return nullptr;
+    }
+
+    m_pipelineLayouts.emplace(std::move(key), handle);
+
+    return handle;
+}
+
+
+PipelineRegistry::Stats PipelineRegistry::getStats() const noexcept
+{
+    Stats stats = {};
+    stats.hits   = m_hits;
+    stats.misses = m_misses;
+
+    {
+        std::lock_guard lock(m_pipelinesMutex);
+        stats.pipelines = static_cast<uint32_t>(m_pipelines.size());
+    }
+
+    std::lock_guard lock(m_layoutsMutex);
+    stats.descriptorSetLayouts = static_cast<uint32_t>(m_descriptorSetLayouts.size());
+    stats.pipelineLayouts      = static_cast<uint32_t>(m_pipelineLayouts.size());
+
+    return stats;
+}
+
+
+std::shared_ptr<GraphicsPipeline> PipelineRegistry::find(const PipelineKey& key) noexcept
+{
+    std::lock_guard lock(m_pipelinesMutex);
+
+    if(auto found = m_pipelines.find(key); found != m_pipelines.end())
+    {
+        ++m_hits;
+        return found->second;
+    }
+
+    return nullptr;
+}
\ No newline at end of file
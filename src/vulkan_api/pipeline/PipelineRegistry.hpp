@@ -0,0 +1,72 @@
+#ifndef PIPELINE_REGISTRY_HPP
+#define PIPELINE_REGISTRY_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/pipeline/PipelineKey.hpp"
+#include "vulkan_api/pipeline/GraphicsPipeline.hpp"
+
+// Builds every distinct pipeline, descriptor set layout and pipeline layout once and hands the same object to everyone asking for it.
+// A GraphicsPipeline::State is reduced to a PipelineKey, a lookup with an equal key returns the pipeline built for the first one,
+// so any number of materials that describe the same state share a single VkPipeline. Layouts are keyed by their bindings and
+// set layouts, pipelines built on equal layouts get the same handles and can be bound with the same descriptor sets.
+// Everything lives until destroy(). May be used from any thread.
+class PipelineRegistry
+{
+public:
+    struct Stats
+    {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t pipelines;
+        uint32_t descriptorSetLayouts;
+        uint32_t pipelineLayouts;
+    };
+
+    PipelineRegistry() noexcept;
+
+    void create(VkDevice device) noexcept;
+
+//  Destroys every pipeline and layout, the device must be idle. Pipelines handed out must not be used afterwards
+    void destroy() noexcept;
+
+//  nullptr when the pipeline failed to build. Two threads missing on the same state at once may both build it,
+//  the second one is dropped and both get the first
+    std::shared_ptr<const GraphicsPipeline> getGraphicsPipeline(const class MainView& view, const GraphicsPipeline::State& state) noexcept;
+
+//  nullptr when no pipeline was built for the state yet, never builds one
+    std::shared_ptr<const GraphicsPipeline> findGraphicsPipeline(const class MainView& view, const GraphicsPipeline::State& state) noexcept;
+
+//  nullptr on failure
+    VkDescriptorSetLayout getDescriptorSetLayout(const DescriptorSetLayout& layout) noexcept;
+    VkPipelineLayout      getPipelineLayout(std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> pushConstants) noexcept;
+
+    Stats getStats() const noexcept;
+
+private:
+    using PipelineMap = std::unordered_map<PipelineKey, std::shared_ptr<GraphicsPipeline>, PipelineKey::Hasher>;
+    template<typename T>
+    using HandleMap = std::unordered_map<PipelineKey, T, PipelineKey::Hasher>;
+
+    std::shared_ptr<GraphicsPipeline> find(const PipelineKey& key) noexcept;
+
+    VkDevice m_device;
+
+    mutable std::mutex m_pipelinesMutex;
+    PipelineMap        m_pipelines;
+
+    mutable std::mutex                    m_layoutsMutex;
+    HandleMap<VkDescriptorSetLayout>      m_descriptorSetLayouts;
+    HandleMap<VkPipelineLayout>           m_pipelineLayouts;
+
+    std::atomic<uint32_t> m_hits;
+    std::atomic<uint32_t> m_misses;
+};
+
+#endif // !PIPELINE_REGISTRY_HPP
\ No newline at end of file
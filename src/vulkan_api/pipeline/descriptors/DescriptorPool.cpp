@@ -80,6 +80,26 @@ void DescriptorPool::writeCombinedImageSampler(const VkDescriptorImageInfo* imag
 }
 
 
+void DescriptorPool::writeStorageBuffer(const VkDescriptorBufferInfo* bufferInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept
+{
+    VkWriteDescriptorSet descriptorWrite = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = nullptr,
+        .dstSet           = descriptorSet,
+        .dstBinding       = dstBinding,
+        .dstArrayElement  = 0,
+        .descriptorCount  = 1,
+        .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo       = nullptr,
+        .pBufferInfo      = bufferInfo,
+        .pTexelBufferView = nullptr
+    };
+
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+
 void DescriptorPool::destroy() noexcept
 {
     if(m_descriptorPool)
@@ -19,6 +19,7 @@ public:
     VkResult create(std::span<const VkDescriptorPoolSize> poolSizes) noexcept;
     VkResult allocateDescriptorSets(std::span<VkDescriptorSet> descriptorSets, std::span<const VkDescriptorSetLayout> layouts) noexcept;
     void writeCombinedImageSampler(const VkDescriptorImageInfo* imageInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept;
+    void writeStorageBuffer(const VkDescriptorBufferInfo* bufferInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept;
 
     void destroy() noexcept;
 
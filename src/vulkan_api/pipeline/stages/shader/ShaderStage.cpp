@@ -16,37 +16,48 @@ ShaderStage::ShaderStage() noexcept:
 
 VkResult ShaderStage::loadFromFile(VkDevice device, VkShaderStageFlagBits stage, const std::filesystem::path& filepath) noexcept
 {
-    if (m_handle)
-        destroy(device);
-
     std::ifstream stream;
     stream.open(filepath, std::ios::ate | std::ios::binary);
 
     if (stream.is_open())
     {
         size_t fileSize = (size_t)stream.tellg();
-        std::vector<char> byte_code(fileSize);
+        std::vector<uint32_t> byte_code((fileSize + sizeof(uint32_t) - 1) / sizeof(uint32_t));
 
         stream.seekg(0);
-        stream.read(byte_code.data(), fileSize);
+        stream.read(reinterpret_cast<char*>(byte_code.data()), fileSize);
         stream.close();
 
-        const VkShaderModuleCreateInfo shaderModuleInfo = 
-        {
-            .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .pNext    = nullptr,
-            .flags    = 0,
-            .codeSize = byte_code.size(),
-            .pCode    = reinterpret_cast<const uint32_t*>(byte_code.data())
-        };
+        return loadFromMemory(device, stage, std::span(reinterpret_cast<const uint8_t*>(byte_code.data()), fileSize));
+    } 
 
-        if (auto result = vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &m_handle); result == VK_SUCCESS)
-        {
-            m_stage = stage;
+    return VK_ERROR_INITIALIZATION_FAILED;
+}
 
-            return result;
-        }
-    } 
+
+VkResult ShaderStage::loadFromMemory(VkDevice device, VkShaderStageFlagBits stage, std::span<const uint8_t> code) noexcept
+{
+    if (m_handle)
+        destroy(device);
+
+    if (code.empty() || code.size() % sizeof(uint32_t) != 0 || reinterpret_cast<uintptr_t>(code.data()) % alignof(uint32_t) != 0)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    const VkShaderModuleCreateInfo shaderModuleInfo = 
+    {
+        .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext    = nullptr,
+        .flags    = 0,
+        .codeSize = code.size(),
+        .pCode    = reinterpret_cast<const uint32_t*>(code.data())
+    };
+
+    if (auto result = vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &m_handle); result == VK_SUCCESS)
+    {
+        m_stage = stage;
+
+        return result;
+    }
 
     return VK_ERROR_INITIALIZATION_FAILED;
 }
@@ -60,6 +71,31 @@ void ShaderStage::destroy(VkDevice device) noexcept
         m_handle = nullptr;
         m_stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
     }
+
+    m_specialization.reset();
+}
+
+
+void ShaderStage::setSpecialization(const SpecializationConstants& constants) noexcept
+{
+    if (constants.empty())
+    {
+        m_specialization.reset();
+        return;
+    }
+
+//  a new object instead of changing the shared one, pipelines built from earlier copies keep their constants
+    auto specialization = std::make_shared<Specialization>();
+    specialization->constants = constants;
+    specialization->info = specialization->constants.getInfo();
+
+    m_specialization = std::move(specialization);
+}
+
+
+const SpecializationConstants* ShaderStage::getSpecialization() const noexcept
+{
+    return m_specialization ? &m_specialization->constants : nullptr;
 }
 
 
@@ -75,11 +111,17 @@ VkPipelineShaderStageCreateInfo ShaderStage::getInfo() const noexcept
             .stage               = m_stage,
             .module              = m_handle,
             .pName               = "main",
-            .pSpecializationInfo = nullptr
+            .pSpecializationInfo = m_specialization ? &m_specialization->info : nullptr
         };
 
         return info;
     }
 
     return {};
+}
+
+
+VkShaderStageFlagBits ShaderStage::getStage() const noexcept
+{
+    return m_stage;
 }
\ No newline at end of file
@@ -1,10 +1,15 @@
 #ifndef SHADER_MODULE_HPP
 #define SHADER_MODULE_HPP
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_api/pipeline/stages/shader/SpecializationConstants.hpp"
+
 
 class ShaderStage
 {
@@ -12,13 +17,31 @@ public:
     ShaderStage() noexcept;
 
     VkResult loadFromFile(VkDevice device, VkShaderStageFlagBits stage, const std::filesystem::path& filepath) noexcept;
+
+//  SPIR-V words, code must be 4-byte aligned and is only read during the call
+    VkResult loadFromMemory(VkDevice device, VkShaderStageFlagBits stage, std::span<const uint8_t> code) noexcept;
     void destroy(VkDevice device) noexcept;
 
+//  Copies the constants, copies of the stage share them. An empty set removes the specialization
+    void setSpecialization(const SpecializationConstants& constants) noexcept;
+
+//  nullptr when the stage is not specialized
+    const SpecializationConstants* getSpecialization() const noexcept;
+
+//  pSpecializationInfo stays valid as long as the stage or a copy of it lives and is not specialized again
     VkPipelineShaderStageCreateInfo getInfo() const noexcept;
+    VkShaderStageFlagBits getStage() const noexcept;
 
 private:
+    struct Specialization
+    {
+        SpecializationConstants constants;
+        VkSpecializationInfo    info; // points into constants
+    };
+
     VkShaderModule m_handle;
     VkShaderStageFlagBits m_stage;
+    std::shared_ptr<const Specialization> m_specialization;
 };
 
 #endif // !SHADER_MODULE_HPP
\ No newline at end of file
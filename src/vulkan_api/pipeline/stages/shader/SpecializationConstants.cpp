@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+#include "vulkan_api/pipeline/stages/shader/SpecializationConstants.hpp"
+
+
+SpecializationConstants& SpecializationConstants::set(uint32_t id, bool value) noexcept
+{
+    write(id, value ? VK_TRUE : VK_FALSE);
+
+    return *this;
+}
+
+
+SpecializationConstants& SpecializationConstants::set(uint32_t id, int32_t value) noexcept
+{
+    write(id, static_cast<uint32_t>(value));
+
+    return *this;
+}
+
+
+SpecializationConstants& SpecializationConstants::set(uint32_t id, uint32_t value) noexcept
+{
+    write(id, value);
+
+    return *this;
+}
+
+
+SpecializationConstants& SpecializationConstants::set(uint32_t id, float value) noexcept
+{
+    write(id, std::bit_cast<uint32_t>(value));
+
+    return *this;
+}
+
+
+void SpecializationConstants::merge(const SpecializationConstants& other) noexcept
+{
+    for (size_t i = 0; i < other.m_entries.size(); ++i)
+        write(other.m_entries[i].constantID, other.m_data[i]);
+}
+
+
+bool SpecializationConstants::empty() const noexcept
+{
+    return m_entries.empty();
+}
+
+
+size_t SpecializationConstants::hash() const noexcept
+{
+    size_t seed = m_entries.size();
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        const uint64_t value = (static_cast<uint64_t>(m_entries[i].constantID) << 32) | m_data[i];
+        seed ^= std::hash<uint64_t>()(value) + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2);
+    }
+
+    return seed;
+}
+
+
+VkSpecializationInfo SpecializationConstants::getInfo() const noexcept
+{
+    return VkSpecializationInfo
+    {
+        .mapEntryCount = static_cast<uint32_t>(m_entries.size()),
+        .pMapEntries   = m_entries.data(),
+        .dataSize      = m_data.size() * sizeof(uint32_t),
+        .pData         = m_data.data()
+    };
+}
+
+
+bool SpecializationConstants::operator == (const SpecializationConstants& other) const noexcept
+{
+    if(m_data != other.m_data || m_entries.size() != other.m_entries.size())
+        return false;
+
+//  offsets and sizes follow from the position, only the ids can differ
+    return std::equal(m_entries.begin(), m_entries.end(), other.m_entries.begin(), [](const auto& a, const auto& b)
+    {
+        return a.constantID == b.constantID;
+    });
+}
+
+
+void SpecializationConstants::write(uint32_t id, uint32_t bits) noexcept
+{
+    const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), id, [](const auto& entry, uint32_t id) { return entry.constantID < id; });
+    const size_t index = static_cast<size_t>(it - m_entries.begin());
+
+    if(it != m_entries.end() && it->constantID == id)
+    {
+        m_data[index] = bits;
+        return;
+    }
+
+    m_entries.insert(it, VkSpecializationMapEntry{ .constantID = id, .offset = 0, .size = sizeof(uint32_t) });
+    m_data.insert(m_data.begin() + index, bits);
+
+    for (size_t i = index; i < m_entries.size(); ++i)
+        m_entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef SPECIALIZATION_CONSTANTS_HPP
+#define SPECIALIZATION_CONSTANTS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Values for the constant_id constants of one shader stage, e.g. layout(constant_id = 0) const bool TEXTURED = true;
+// The driver folds them into the pipeline, so branches and loop counts that depend on them cost nothing at run time.
+// Every constant takes 4 bytes, which covers bool, int, uint and float; constants are kept sorted by id,
+// so two objects holding the same values compare and hash equal no matter the order they were set in.
+class SpecializationConstants
+{
+public:
+    SpecializationConstants& set(uint32_t id, bool value)     noexcept; // VkBool32 in the shader
+    SpecializationConstants& set(uint32_t id, int32_t value)  noexcept;
+    SpecializationConstants& set(uint32_t id, uint32_t value) noexcept;
+    SpecializationConstants& set(uint32_t id, float value)    noexcept;
+
+//  Constants of other replace the ones with the same id
+    void merge(const SpecializationConstants& other) noexcept;
+
+    bool   empty() const noexcept;
+    size_t hash()  const noexcept;
+
+//  Points into this object, valid until it is changed or destroyed
+    VkSpecializationInfo getInfo() const noexcept;
+
+    bool operator == (const SpecializationConstants& other) const noexcept;
+
+private:
+    void write(uint32_t id, uint32_t bits) noexcept;
+
+    std::vector<VkSpecializationMapEntry> m_entries; // by constantID, entry i at offset i * 4
+    std::vector<uint32_t>                 m_data;
+};
+
+#endif // !SPECIALIZATION_CONSTANTS_HPP
\ No newline at end of file
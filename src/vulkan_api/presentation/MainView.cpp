@@ -1,5 +1,7 @@
+#include <array>
 #include <vector>
 #include <memory>
+#include <cstdio>
 
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
@@ -79,8 +81,9 @@ MainView::MainView() noexcept:
     m_surface(VK_NULL_HANDLE),
     m_swapchain(VK_NULL_HANDLE),
     m_depthImage(VK_NULL_HANDLE),
-    m_depthImageMemory(VK_NULL_HANDLE),
+    m_depthImageMemory(),
     m_depthImageView(VK_NULL_HANDLE),
+    m_depthFormat(VK_FORMAT_UNDEFINED),
     m_format(VK_FORMAT_UNDEFINED),
     m_extent({})
 {
@@ -124,7 +127,7 @@ VkResult MainView::create(VulkanContext& context, GLFWwindow* window) noexcept
         .window = static_cast<xcb_window_t>(glfwGetX11Window(window))
     };
 
-    if (vkCreateXcbSurfaceKHR(api.getInstance(), &surfaceInfo, nullptr, &m_surface) == VK_SUCCESS)
+    if (vkCreateXcbSurfaceKHR(context.getInstance(), &surfaceInfo, nullptr, &m_surface) == VK_SUCCESS)
         return recreate(true);
 #endif
 
@@ -132,6 +135,40 @@ VkResult MainView::create(VulkanContext& context, GLFWwindow* window) noexcept
 }
 
 
+VkResult MainView::createHeadless(VulkanContext& context, VkExtent2D extent, bool useHeadlessSurface) noexcept
+{
+    m_context = &context;
+    m_extent  = extent;
+
+    if (useHeadlessSurface && context.getFeatures().headlessSurface)
+    {
+        auto createHeadlessSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(vkGetInstanceProcAddr(context.getInstance(), "vkCreateHeadlessSurfaceEXT"));
+
+        const VkHeadlessSurfaceCreateInfoEXT surfaceInfo = 
+        {
+            .sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+            .pNext = nullptr,
+            .flags = 0
+        };
+
+        if (createHeadlessSurface && createHeadlessSurface(context.getInstance(), &surfaceInfo, nullptr, &m_surface) == VK_SUCCESS)
+            return recreate(true);
+
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (useHeadlessSurface)
+        printf("VK_EXT_headless_surface is not available, rendering into offscreen images\n");
+
+    if (auto result = createOffscreenImages(); result != VK_SUCCESS)
+        return result;
+
+    createDepthResources();
+
+    return m_depthImageView ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED;
+}
+
+
 VkResult MainView::recreate(bool depth) noexcept
 {
     auto choose_swap_extent = [](const VkSurfaceCapabilitiesKHR& capabilities, const VkExtent2D& currentExtent) -> VkExtent2D
@@ -218,11 +255,7 @@ VkResult MainView::recreate(bool depth) noexcept
                     if (m_depthImageView)
                         vkDestroyImageView(device, m_depthImageView, VK_NULL_HANDLE);
 
-                    if (m_depthImage)
-                        vkDestroyImage(device, m_depthImage, VK_NULL_HANDLE);
-
-                    if (m_depthImageMemory)
-                        vkFreeMemory(device, m_depthImageMemory, VK_NULL_HANDLE);
+                    m_context->getAllocator().destroyImage(m_depthImage, m_depthImageMemory);
 
                     createDepthResources();
                 }
@@ -251,14 +284,19 @@ void MainView::destroy() noexcept
             vkDestroySwapchainKHR(device, m_swapchain, nullptr);
         }
 
+        if(!m_offscreenMemory.empty())
+        {
+            for (size_t i = 0; i < m_images.size(); ++i)
+            {
+                vkDestroyImageView(device, m_imageViews[i], nullptr);
+                m_context->getAllocator().destroyImage(m_images[i], m_offscreenMemory[i]);
+            }
+        }
+
         if (m_depthImageView)
             vkDestroyImageView(device, m_depthImageView, VK_NULL_HANDLE);
 
-        if (m_depthImage)
-            vkDestroyImage(device, m_depthImage, VK_NULL_HANDLE);
-
-        if (m_depthImageMemory)
-            vkFreeMemory(device, m_depthImageMemory, VK_NULL_HANDLE);
+        m_context->getAllocator().destroyImage(m_depthImage, m_depthImageMemory);
 
         if(m_surface)
             vkDestroySurfaceKHR(instance, m_surface, VK_NULL_HANDLE);
@@ -278,12 +316,30 @@ VkFormat MainView::getFormat() const noexcept
 }
 
 
+VkFormat MainView::getDepthFormat() const noexcept
+{
+    return m_depthFormat;
+}
+
+
 const VkExtent2D& MainView::getExtent() const noexcept
 {
     return m_extent;
 }
 
 
+bool MainView::isOffscreen() const noexcept
+{
+    return !m_offscreenMemory.empty();
+}
+
+
+VkImageLayout MainView::getFinalLayout() const noexcept
+{
+    return isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
+
 VkImage MainView::getImage(uint32_t index) const noexcept
 {
     return m_images[index];
@@ -308,13 +364,44 @@ VulkanContext* MainView::getContext() const noexcept
 }
 
 
+VkResult MainView::createOffscreenImages() noexcept
+{
+    auto GPU    = m_context->getPhysicalDevice();
+    auto device = m_context->getDevice();
+
+    constexpr std::array<const VkFormat, 2> formats = { VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB };
+
+    m_format = vk::findSupportedFormat(formats, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT, GPU);
+
+    if (m_format == VK_FORMAT_UNDEFINED)
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+
+    m_images.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    m_imageViews.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    m_offscreenMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < m_images.size(); ++i)
+    {
+        if (auto result = vk::createImage2D(m_extent.width, m_extent.height, m_format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_images[i], m_offscreenMemory[i], m_context->getAllocator()); result != VK_SUCCESS)
+            return result;
+
+        if (auto result = vk::createImageView2D(device, m_images[i], m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_imageViews[i]); result != VK_SUCCESS)
+            return result;
+    }
+
+    return VK_SUCCESS;
+}
+
+
 void MainView::createDepthResources() noexcept
 {
     if (auto device = m_context->getDevice())
     {
         if (VkFormat depthFormat = vk::findDepthFormat(m_context->getPhysicalDevice()); depthFormat != VK_FORMAT_UNDEFINED)
         {
-            vk::createImage2D(m_extent.width, m_extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory, m_context->getPhysicalDevice(), device);
+            m_depthFormat = depthFormat;
+
+            vk::createImage2D(m_extent.width, m_extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory, m_context->getAllocator());
             vk::createImageView2D(device, m_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, m_depthImageView);
         }
     }
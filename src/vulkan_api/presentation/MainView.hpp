@@ -13,13 +13,21 @@ public:
     ~MainView();
 
     VkResult create(VulkanContext& context, struct GLFWwindow* window) noexcept;
+
+//  Without a window: a swapchain on a VK_EXT_headless_surface when requested and supported,
+//  otherwise MAX_FRAMES_IN_FLIGHT offscreen images that are rendered into in turn
+    VkResult createHeadless(VulkanContext& context, VkExtent2D extent, bool useHeadlessSurface) noexcept;
     VkResult recreate(bool depth) noexcept;
     void     destroy()  noexcept;
 
     VkSwapchainKHR&   getSwapchain() noexcept;
     VkFormat          getFormat()    const noexcept;
+    VkFormat          getDepthFormat() const noexcept;
     const VkExtent2D& getExtent()    const noexcept;
 
+    bool          isOffscreen()    const noexcept;
+    VkImageLayout getFinalLayout() const noexcept;
+
     VkImage     getImage(uint32_t index)     const noexcept;
     VkImageView getImageView(uint32_t index) const noexcept;
     VkImageView getDepthImageView()          const noexcept;
@@ -27,6 +35,7 @@ public:
     VulkanContext* getContext() const noexcept;
 
 private:
+    VkResult createOffscreenImages() noexcept;
     void createDepthResources() noexcept;
 
     VulkanContext* m_context;
@@ -37,10 +46,14 @@ private:
     std::vector<VkImage>     m_images;
     std::vector<VkImageView> m_imageViews;
 
+//  Only owned in offscreen mode, swapchain images belong to the swapchain
+    std::vector<MemoryAllocator::Allocation> m_offscreenMemory;
+
 //  Depth buffer
-    VkImage        m_depthImage;
-    VkDeviceMemory m_depthImageMemory;
-    VkImageView    m_depthImageView;
+    VkImage                     m_depthImage;
+    MemoryAllocator::Allocation m_depthImageMemory;
+    VkImageView                 m_depthImageView;
+    VkFormat                    m_depthFormat;
 
     VkFormat   m_format;
     VkExtent2D m_extent;
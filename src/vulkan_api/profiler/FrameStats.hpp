@@ -0,0 +1,56 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <cstdint>
+
+
+// Commands recorded on the CPU, counted where the vkCmd* call is made
+struct CommandCounters
+{
+    uint32_t draws              = 0;
+    uint32_t dispatches         = 0;
+    uint32_t pipelineBinds      = 0;
+    uint32_t descriptorSetBinds = 0;
+    uint32_t bufferBinds        = 0; // vertex + index
+    uint32_t pushConstants      = 0;
+    uint32_t dynamicStates      = 0; // vkCmdSet* calls beyond viewport and scissor
+    uint32_t barriers           = 0;
+    uint32_t submits            = 0;
+
+    CommandCounters& operator += (const CommandCounters& other) noexcept
+    {
+        draws              += other.draws;
+        dispatches         += other.dispatches;
+        pipelineBinds      += other.pipelineBinds;
+        descriptorSetBinds += other.descriptorSetBinds;
+        bufferBinds        += other.bufferBinds;
+        pushConstants      += other.pushConstants;
+        dynamicStates      += other.dynamicStates;
+        barriers           += other.barriers;
+        submits            += other.submits;
+
+        return *this;
+    }
+};
+
+
+// VK_QUERY_TYPE_PIPELINE_STATISTICS results, in the bit order of VkQueryPipelineStatisticFlagBits
+struct PipelineStatistics
+{
+    uint64_t inputVertices       = 0;
+    uint64_t inputPrimitives     = 0;
+    uint64_t vertexInvocations   = 0;
+    uint64_t clippingPrimitives  = 0; // primitives that survived clipping
+    uint64_t fragmentInvocations = 0;
+    uint64_t computeInvocations  = 0;
+};
+
+
+struct FrameStats
+{
+    CommandCounters    commands;
+    PipelineStatistics pipeline;      // GPU work of the frame resolved MAX_FRAMES_IN_FLIGHT frames ago
+    bool               pipelineValid = false;
+};
+
+#endif // !FRAME_STATS_HPP
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <vector>
+
+#include "vulkan_api/profiler/GpuProfiler.hpp"
+
+
+GpuProfiler::GpuProfiler() noexcept:
+    m_queryPool(VK_NULL_HANDLE),
+    m_timestampPeriod(0.0),
+    m_timestampMask(0),
+    m_frame(0),
+    m_scopes({}),
+    m_results({}),
+    m_resultCount(0)
+{
+
+}
+
+
+bool GpuProfiler::create(VkPhysicalDevice GPU, VkDevice device, uint32_t queueFamilyIndex) noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GPU, &properties);
+
+    uint32_t queueFamilyCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(GPU, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(GPU, &queueFamilyCount, queueFamilies.data());
+
+    const uint32_t validBits = (queueFamilyIndex < queueFamilyCount) ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.f)
+        return false;
+
+    m_timestampPeriod = properties.limits.timestampPeriod;
+    m_timestampMask   = (validBits >= 64) ? UINT64_MAX : ((uint64_t(1) << validBits) - 1);
+
+    const VkQueryPoolCreateInfo queryPoolInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext              = nullptr,
+        .flags              = 0,
+        .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount         = 2 * MAX_SCOPES * MAX_FRAMES_IN_FLIGHT,
+        .pipelineStatistics = 0
+    };
+
+    return vkCreateQueryPool(device, &queryPoolInfo, nullptr, &m_queryPool) == VK_SUCCESS;
+}
+
+
+void GpuProfiler::destroy(VkDevice device) noexcept
+{
+    if (m_queryPool)
+        vkDestroyQueryPool(device, m_queryPool, nullptr);
+
+    m_queryPool = VK_NULL_HANDLE;
+}
+
+
+bool GpuProfiler::isEnabled() const noexcept
+{
+    return m_queryPool != VK_NULL_HANDLE;
+}
+
+
+void GpuProfiler::beginFrame(VkDevice device, VkCommandBuffer cmd, uint32_t frame) noexcept
+{
+    if (!m_queryPool)
+        return;
+
+    m_frame = frame;
+    auto& scopes = m_scopes[frame];
+
+    if (scopes.count > 0)
+    {
+        std::array<uint64_t, 2 * MAX_SCOPES> timestamps;
+
+        // no WAIT bit: the frame's timeline value has been waited on, anything not available belongs to a frame that was never submitted
+        if (vkGetQueryPoolResults(device, m_queryPool, getFirstQuery(frame), 2 * scopes.count, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            for (uint32_t i = 0; i < scopes.count; ++i)
+            {
+                const uint64_t ticks = (timestamps[2 * i + 1] - timestamps[2 * i]) & m_timestampMask;
+
+                m_results[i].name         = scopes.names[i];
+                m_results[i].milliseconds = ticks * m_timestampPeriod * 1e-6;
+            }
+
+            m_resultCount = scopes.count;
+        }
+    }
+
+    scopes.count = 0;
+    vkCmdResetQueryPool(cmd, m_queryPool, getFirstQuery(frame), 2 * MAX_SCOPES);
+}
+
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer cmd, const char* name) noexcept
+{
+    const uint32_t scope = reserveScope(name);
+    writeBegin(cmd, scope);
+
+    return scope;
+}
+
+
+void GpuProfiler::endScope(VkCommandBuffer cmd, uint32_t scope) noexcept
+{
+    writeEnd(cmd, scope);
+}
+
+
+uint32_t GpuProfiler::reserveScope(const char* name) noexcept
+{
+    auto& scopes = m_scopes[m_frame];
+
+    if (!m_queryPool || scopes.count == MAX_SCOPES)
+        return UINT32_MAX;
+
+    scopes.names[scopes.count] = name;
+
+    return scopes.count++;
+}
+
+
+void GpuProfiler::writeBegin(VkCommandBuffer cmd, uint32_t scope) const noexcept
+{
+    if (scope != UINT32_MAX)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, getFirstQuery(m_frame) + 2 * scope);
+}
+
+
+void GpuProfiler::writeEnd(VkCommandBuffer cmd, uint32_t scope) const noexcept
+{
+    if (scope != UINT32_MAX)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, getFirstQuery(m_frame) + 2 * scope + 1);
+}
+
+
+std::span<const GpuProfiler::ScopeResult> GpuProfiler::getResults() const noexcept
+{
+    return std::span(m_results.data(), m_resultCount);
+}
+
+
+uint32_t GpuProfiler::getFirstQuery(uint32_t frame) const noexcept
+{
+    return frame * 2 * MAX_SCOPES;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include <array>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/utils/Defines.hpp"
+
+// Named GPU scopes measured with timestamp queries.
+// Every frame in flight owns a slice of the query pool. The slice is read back when the frame slot comes around again,
+// MAX_FRAMES_IN_FLIGHT frames later, after its timeline value has been waited on, so the results never stall the queue.
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t MAX_SCOPES = 32;
+
+    struct ScopeResult
+    {
+        const char* name;
+        double      milliseconds;
+    };
+
+    GpuProfiler() noexcept;
+
+//  Returns false if the queue family cannot write timestamps, the profiler then stays disabled and every call is a no-op
+    bool create(VkPhysicalDevice GPU, VkDevice device, uint32_t queueFamilyIndex) noexcept;
+    void destroy(VkDevice device) noexcept;
+
+    bool isEnabled() const noexcept;
+
+//  Resolves what this frame slot measured last time and resets its queries, must be recorded outside of rendering
+    void beginFrame(VkDevice device, VkCommandBuffer cmd, uint32_t frame) noexcept;
+
+//  name must outlive the profiler, string literals are expected
+    uint32_t beginScope(VkCommandBuffer cmd, const char* name) noexcept;
+    void     endScope(VkCommandBuffer cmd, uint32_t scope) noexcept;
+
+//  For scopes that open and close in different command buffers, e.g. the first and last secondary buffer of a pass
+    uint32_t reserveScope(const char* name) noexcept;
+    void     writeBegin(VkCommandBuffer cmd, uint32_t scope) const noexcept;
+    void     writeEnd(VkCommandBuffer cmd, uint32_t scope) const noexcept;
+
+//  Scopes of the most recently resolved frame
+    std::span<const ScopeResult> getResults() const noexcept;
+
+private:
+    struct FrameScopes
+    {
+        std::array<const char*, MAX_SCOPES> names;
+        uint32_t count;
+    };
+
+    uint32_t getFirstQuery(uint32_t frame) const noexcept;
+
+    VkQueryPool m_queryPool;
+    double      m_timestampPeriod; // nanoseconds per tick
+    uint64_t    m_timestampMask;
+    uint32_t    m_frame;
+
+    std::array<FrameScopes, MAX_FRAMES_IN_FLIGHT> m_scopes;
+    std::array<ScopeResult, MAX_SCOPES>           m_results;
+    uint32_t                                      m_resultCount;
+};
+
+#endif // !GPU_PROFILER_HPP
\ No newline at end of file
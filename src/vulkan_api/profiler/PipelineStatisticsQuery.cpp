@@ -0,0 +1,80 @@
+#include "vulkan_api/profiler/PipelineStatisticsQuery.hpp"
+
+
+PipelineStatisticsQuery::PipelineStatisticsQuery() noexcept:
+    m_queryPool(VK_NULL_HANDLE),
+    m_frame(0),
+    m_written({})
+{
+
+}
+
+
+bool PipelineStatisticsQuery::create(VkDevice device) noexcept
+{
+    const VkQueryPoolCreateInfo queryPoolInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext              = nullptr,
+        .flags              = 0,
+        .queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+        .queryCount         = MAX_FRAMES_IN_FLIGHT,
+        .pipelineStatistics = STATISTICS
+    };
+
+    return vkCreateQueryPool(device, &queryPoolInfo, nullptr, &m_queryPool) == VK_SUCCESS;
+}
+
+
+void PipelineStatisticsQuery::destroy(VkDevice device) noexcept
+{
+    if (m_queryPool)
+        vkDestroyQueryPool(device, m_queryPool, nullptr);
+
+    m_queryPool = VK_NULL_HANDLE;
+}
+
+
+bool PipelineStatisticsQuery::isEnabled() const noexcept
+{
+    return m_queryPool != VK_NULL_HANDLE;
+}
+
+
+bool PipelineStatisticsQuery::beginFrame(VkDevice device, VkCommandBuffer cmd, uint32_t frame, PipelineStatistics& stats) noexcept
+{
+    if (!m_queryPool)
+        return false;
+
+    m_frame = frame;
+    bool resolved = false;
+
+    if (m_written[frame])
+    {
+        static_assert(sizeof(PipelineStatistics) == 6 * sizeof(uint64_t), "one uint64_t per statistic bit");
+
+        resolved = vkGetQueryPoolResults(device, m_queryPool, frame, 1, sizeof(stats), &stats, sizeof(stats), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+    }
+
+    m_written[frame] = false;
+    vkCmdResetQueryPool(cmd, m_queryPool, frame, 1);
+
+    return resolved;
+}
+
+
+void PipelineStatisticsQuery::begin(VkCommandBuffer cmd) noexcept
+{
+    if (m_queryPool)
+        vkCmdBeginQuery(cmd, m_queryPool, m_frame, 0);
+}
+
+
+void PipelineStatisticsQuery::end(VkCommandBuffer cmd) noexcept
+{
+    if (m_queryPool)
+    {
+        vkCmdEndQuery(cmd, m_queryPool, m_frame);
+        m_written[m_frame] = true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef PIPELINE_STATISTICS_QUERY_HPP
+#define PIPELINE_STATISTICS_QUERY_HPP
+
+#include <array>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/utils/Defines.hpp"
+#include "vulkan_api/profiler/FrameStats.hpp"
+
+// One pipeline statistics query per frame in flight around the scene pass.
+// Resolved the same way as GpuProfiler: when the frame slot is reused, after its timeline value was waited on.
+class PipelineStatisticsQuery
+{
+public:
+    static constexpr VkQueryPipelineStatisticFlags STATISTICS = 
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT      |
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT    |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT    |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT          |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT  |
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    PipelineStatisticsQuery() noexcept;
+
+//  Requires the pipelineStatisticsQuery feature, stays disabled otherwise
+    bool create(VkDevice device) noexcept;
+    void destroy(VkDevice device) noexcept;
+
+    bool isEnabled() const noexcept;
+
+//  Resolves the previous use of this frame slot into stats and resets the query, must be recorded outside of rendering
+    bool beginFrame(VkDevice device, VkCommandBuffer cmd, uint32_t frame, PipelineStatistics& stats) noexcept;
+
+    void begin(VkCommandBuffer cmd) noexcept;
+    void end(VkCommandBuffer cmd) noexcept;
+
+private:
+    VkQueryPool m_queryPool;
+    uint32_t    m_frame;
+
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_written;
+};
+
+#endif // !PIPELINE_STATISTICS_QUERY_HPP
\ No newline at end of file
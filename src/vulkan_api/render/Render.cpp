@@ -1,9 +1,9 @@
 #include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/profiler/GpuProfiler.hpp"
 #include "vulkan_api/render/Render.hpp"
 
 
-// TODO add clear color value
-VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex) noexcept
+VkResult Render::beginFrame(VkCommandBuffer cmd) noexcept
 {
     VkCommandBufferBeginInfo beginInfo = 
     {
@@ -13,8 +13,20 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
         .pInheritanceInfo = nullptr
     };
 
-    if (auto result = vkBeginCommandBuffer(cmd, &beginInfo); result != VK_SUCCESS)
-        return result;
+    return vkBeginCommandBuffer(cmd, &beginInfo);
+}
+
+
+VkResult Render::endFrame(VkCommandBuffer cmd) noexcept
+{
+    return vkEndCommandBuffer(cmd);
+}
+
+
+// TODO add clear color value
+VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex, VkRenderingFlags flags, GpuProfiler* profiler, CommandCounters* counters) noexcept
+{
+    const uint32_t scope = profiler ? profiler->beginScope(cmd, "render.begin") : UINT32_MAX;
 
     const VkImageMemoryBarrier imageMemoryBarrier =
     {
@@ -50,6 +62,13 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
         &imageMemoryBarrier // pImageMemoryBarriers
     );
 
+    // timestamps are not allowed inside a rendering scope that only executes secondary command buffers
+    if (profiler)
+        profiler->endScope(cmd, scope);
+
+    if (counters)
+        ++counters->barriers;
+
     VkExtent2D extent = view.getExtent();
 
     const VkRenderingAttachmentInfoKHR colorAttachmentInfo = 
@@ -84,7 +103,7 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
     {
         .sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
         .pNext                = VK_NULL_HANDLE,
-        .flags                = 0,
+        .flags                = flags,
         .renderArea           = { { 0, 0 }, extent },
         .layerCount           = 1,
         .viewMask             = 0,
@@ -96,34 +115,20 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
 
     vkCmdBeginRendering(cmd, &renderingInfo);
 
-    VkViewport viewport = 
-    {
-        .x = 0.f,
-        .y = 0.f,
-        .width = static_cast<float>(extent.width),
-        .height = static_cast<float>(extent.height),
-        .minDepth = 0.f,
-        .maxDepth = 1.f
-    };
-
-    vkCmdSetViewport(cmd, 0, 1, &viewport);
-
-    VkRect2D scissor = 
-    {
-        .offset = { 0, 0 },
-        .extent = extent
-    };
-
-    vkCmdSetScissor(cmd, 0, 1, &scissor);
+    // dynamic state is not inherited by secondary command buffers, they set it themselves
+    if (!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT))
+        setViewport(cmd, extent);
 
     return VK_SUCCESS;
 }
 
 
-VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex) noexcept
+VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex, GpuProfiler* profiler, CommandCounters* counters) noexcept
 {
     vkCmdEndRendering(cmd);
 
+    const uint32_t scope = profiler ? profiler->beginScope(cmd, "render.end") : UINT32_MAX;
+
     const VkImageMemoryBarrier imageMemoryBarrier =
     {
         .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -131,7 +136,7 @@ VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIn
         .srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
         .dstAccessMask       = VK_ACCESS_NONE,
         .oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        .newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        .newLayout           = view.getFinalLayout(), // PRESENT_SRC_KHR, or TRANSFER_SRC_OPTIMAL for offscreen targets
         .srcQueueFamilyIndex = 0,
         .dstQueueFamilyIndex = 0,
         .image               = view.getImage(imageIndex),
@@ -158,5 +163,87 @@ VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIn
         &imageMemoryBarrier // pImageMemoryBarriers
     );
 
+    if (profiler)
+        profiler->endScope(cmd, scope);
+
+    if (counters)
+        ++counters->barriers;
+
+    return VK_SUCCESS;
+}
+
+
+VkResult Render::beginSecondary(VkCommandBuffer cmd, const MainView& view, VkQueryPipelineStatisticFlags pipelineStatistics) noexcept
+{
+    const VkFormat colorFormat = view.getFormat();
+
+    const VkCommandBufferInheritanceRenderingInfoKHR inheritanceRenderingInfo = 
+    {
+        .sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+        .pNext                   = nullptr,
+        .flags                   = 0,
+        .viewMask                = 0,
+        .colorAttachmentCount    = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat   = view.getDepthFormat(),
+        .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+        .rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT
+    };
+
+    const VkCommandBufferInheritanceInfo inheritanceInfo = 
+    {
+        .sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext                = &inheritanceRenderingInfo,
+        .renderPass           = VK_NULL_HANDLE,
+        .subpass              = 0,
+        .framebuffer          = VK_NULL_HANDLE,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags           = 0,
+        .pipelineStatistics   = pipelineStatistics
+    };
+
+    const VkCommandBufferBeginInfo beginInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+    if (auto result = vkBeginCommandBuffer(cmd, &beginInfo); result != VK_SUCCESS)
+        return result;
+
+    setViewport(cmd, view.getExtent());
+
+    return VK_SUCCESS;
+}
+
+
+VkResult Render::endSecondary(VkCommandBuffer cmd) noexcept
+{
     return vkEndCommandBuffer(cmd);
+}
+
+
+void Render::setViewport(VkCommandBuffer cmd, const VkExtent2D& extent) noexcept
+{
+    VkViewport viewport = 
+    {
+        .x = 0.f,
+        .y = 0.f,
+        .width = static_cast<float>(extent.width),
+        .height = static_cast<float>(extent.height),
+        .minDepth = 0.f,
+        .maxDepth = 1.f
+    };
+
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor = 
+    {
+        .offset = { 0, 0 },
+        .extent = extent
+    };
+
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
 }
\ No newline at end of file
@@ -3,12 +3,27 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_api/profiler/FrameStats.hpp"
+
 
 class Render
 {
 public:
-    static VkResult begin(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex) noexcept;
-    static VkResult end(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex) noexcept;
+    static VkResult beginFrame(VkCommandBuffer cmd) noexcept;
+    static VkResult endFrame(VkCommandBuffer cmd) noexcept;
+
+//  With a profiler the attachment barriers are measured as the "render.begin" and "render.end" scopes,
+//  with counters the barriers are added to CommandCounters::barriers
+    static VkResult begin(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex, VkRenderingFlags flags = 0, class GpuProfiler* profiler = nullptr, CommandCounters* counters = nullptr) noexcept;
+    static VkResult end(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex, class GpuProfiler* profiler = nullptr, CommandCounters* counters = nullptr) noexcept;
+
+//  Secondary command buffers executed inside a begin(..., VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT) scope.
+//  pipelineStatistics must match an active pipeline statistics query of the primary (requires inheritedQueries).
+    static VkResult beginSecondary(VkCommandBuffer cmd, const class MainView& view, VkQueryPipelineStatisticFlags pipelineStatistics = 0) noexcept;
+    static VkResult endSecondary(VkCommandBuffer cmd) noexcept;
+
+private:
+    static void setViewport(VkCommandBuffer cmd, const VkExtent2D& extent) noexcept;
 };
 
 #endif // !RENDER_HPP
\ No newline at end of file
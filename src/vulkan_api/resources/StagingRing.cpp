@@ -0,0 +1,112 @@
+#include <algorithm>
+
+#include "vulkan_api/resources/StagingRing.hpp"
+
+
+StagingRing::StagingRing() noexcept:
+    m_allocator(nullptr),
+    m_buffer(nullptr),
+    m_memory(),
+    m_data(nullptr),
+    m_capacity(0),
+    m_alignment(16),
+    m_head(0),
+    m_tail(0),
+    m_nextRegion(1)
+{
+
+}
+
+
+bool StagingRing::create(VkPhysicalDevice GPU, MemoryAllocator& allocator, VkDeviceSize capacity) noexcept
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GPU, &properties);
+
+//  16 also covers the texel size of every uncompressed format the copies may target,
+//  a capacity that is a multiple of the alignment keeps wrapped offsets aligned
+    m_alignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 16);
+    m_capacity  = (capacity + m_alignment - 1) & ~(m_alignment - 1);
+    m_allocator = &allocator;
+
+    if(allocator.createBuffer(m_capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_buffer, m_memory) != VK_SUCCESS)
+        return false;
+
+//  the allocator keeps host-visible memory mapped, the pointer already includes the offset into the block
+    m_data = static_cast<uint8_t*>(m_memory.mapped);
+
+    m_head = m_tail = 0;
+    m_regions.clear();
+
+    return true;
+}
+
+
+void StagingRing::destroy() noexcept
+{
+    if(m_allocator)
+        m_allocator->destroyBuffer(m_buffer, m_memory);
+
+    m_data   = nullptr;
+    m_buffer = nullptr;
+    m_regions.clear();
+}
+
+
+bool StagingRing::allocate(VkDeviceSize size, Allocation& allocation) noexcept
+{
+    if(!m_data || size > m_capacity)
+        return false;
+
+    uint64_t offset = (m_head + m_alignment - 1) & ~(m_alignment - 1);
+
+//  an allocation never straddles the end of the buffer, the rest of the lap is skipped
+    if(offset % m_capacity + size > m_capacity)
+        offset += m_capacity - offset % m_capacity;
+
+    if(offset + size - m_tail > m_capacity)
+        return false;
+
+    m_head = offset + size;
+
+    allocation.buffer = m_buffer;
+    allocation.offset = offset % m_capacity;
+    allocation.data   = m_data + allocation.offset;
+
+    return true;
+}
+
+
+uint64_t StagingRing::close() noexcept
+{
+    m_regions.push_back({ m_nextRegion, m_head, false });
+
+    return m_nextRegion++;
+}
+
+
+void StagingRing::release(uint64_t region) noexcept
+{
+    auto it = std::find_if(m_regions.begin(), m_regions.end(), [region](const Region& r) { return r.id == region; });
+
+    if(it != m_regions.end())
+        it->released = true;
+
+    while (!m_regions.empty() && m_regions.front().released)
+    {
+        m_tail = m_regions.front().end;
+        m_regions.pop_front();
+    }
+}
+
+
+VkDeviceSize StagingRing::getCapacity() const noexcept
+{
+    return m_capacity;
+}
+
+
+VkDeviceSize StagingRing::getUsedSize() const noexcept
+{
+    return m_head - m_tail;
+}
\ No newline at end of file
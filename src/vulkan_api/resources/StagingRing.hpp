@@ -0,0 +1,66 @@
+#ifndef STAGING_RING_HPP
+#define STAGING_RING_HPP
+
+#include <deque>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+
+// One persistently mapped, host-coherent staging buffer shared by every upload.
+// Allocations are handed out front to back and wrap around, they are grouped into regions by close()
+// and a region is reclaimed once release() was called for it and for every region before it,
+// i.e. after the timeline value of the submission that read it has been reached. Regions may be released in any order.
+class StagingRing
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_CAPACITY = 32ULL << 20;
+
+    struct Allocation
+    {
+        VkBuffer     buffer = nullptr;
+        VkDeviceSize offset = 0;
+        void*        data   = nullptr;
+    };
+
+    StagingRing() noexcept;
+
+    bool create(VkPhysicalDevice GPU, MemoryAllocator& allocator, VkDeviceSize capacity = DEFAULT_CAPACITY) noexcept;
+    void destroy() noexcept;
+
+//  Offsets are aligned to optimalBufferCopyOffsetAlignment. Fails without side effects when the ring has no room
+//  until older regions are released, the caller then needs a staging buffer of its own
+    bool allocate(VkDeviceSize size, Allocation& allocation) noexcept;
+
+//  Seals the allocations made since the previous close into a region, returns its id
+    uint64_t close() noexcept;
+
+//  The GPU is done reading the region
+    void release(uint64_t region) noexcept;
+
+    VkDeviceSize getCapacity() const noexcept;
+    VkDeviceSize getUsedSize() const noexcept;
+
+private:
+    struct Region
+    {
+        uint64_t id;
+        uint64_t end;
+        bool     released;
+    };
+
+    MemoryAllocator*            m_allocator;
+    VkBuffer                    m_buffer;
+    MemoryAllocator::Allocation m_memory;
+    uint8_t*                    m_data;
+    VkDeviceSize                m_capacity;
+    VkDeviceSize                m_alignment;
+
+//  head and tail count bytes ever allocated, the position in the buffer is the value modulo the capacity
+    uint64_t                    m_head;
+    uint64_t                    m_tail;
+    uint64_t                    m_nextRegion;
+    std::deque<Region>          m_regions;
+};
+
+#endif // !STAGING_RING_HPP
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <cstdio>
+#include <cstring>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/resources/UploadBatch.hpp"
+
+
+UploadBatch::UploadBatch() noexcept:
+    m_allocator(nullptr),
+    m_device(nullptr),
+    m_pool(nullptr),
+    m_cmd(nullptr),
+    m_timeline(nullptr),
+    m_timelineValue(0),
+    m_ring(nullptr),
+    m_ringRegion(0),
+    m_stagingSize(0),
+    m_dedicatedSize(0),
+    m_commandCount(0),
+    m_submitted(false)
+{
+
+}
+
+
+bool UploadBatch::begin(MemoryAllocator& allocator, VkDevice device, VkCommandPool pool, StagingRing* ring) noexcept
+{
+    if(m_cmd)
+        return false; // still recording or in flight
+
+    m_allocator = &allocator;
+    m_device    = device;
+    m_pool      = pool;
+    m_ring      = ring;
+
+    const VkCommandBufferAllocateInfo allocInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext              = nullptr,
+        .commandPool        = pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+
+    const VkCommandBufferBeginInfo beginInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr
+    };
+
+    if(vkAllocateCommandBuffers(device, &allocInfo, &m_cmd) != VK_SUCCESS)
+    {
+        m_cmd = nullptr;
+        return false;
+    }
+
+    if(vkBeginCommandBuffer(m_cmd, &beginInfo) != VK_SUCCESS)
+    {
+        release();
+        return false;
+    }
+
+    m_commandCount  = 0;
+    m_stagingSize   = 0;
+    m_dedicatedSize = 0;
+    m_submitted     = false;
+
+    return true;
+}
+
+
+bool UploadBatch::allocateStaging(VkDeviceSize size, StagingRegion& region) noexcept
+{
+    if(!m_cmd || m_submitted)
+        return false;
+
+    if(!(m_ring && m_ring->allocate(size, region)) && !allocateDedicated(size, region))
+        return false;
+
+    m_stagingSize += size;
+
+    return true;
+}
+
+
+bool UploadBatch::uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset) noexcept
+{
+    StagingRegion region;
+
+    if(!allocateStaging(size, region))
+        return false;
+
+    memcpy(region.data, data, static_cast<size_t>(size));
+    copyBuffer(region, dst, size, dstOffset);
+
+    return true;
+}
+
+
+void UploadBatch::copyBuffer(const StagingRegion& src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset) noexcept
+{
+    const VkBufferCopy copyRegion = 
+    {
+        .srcOffset = src.offset,
+        .dstOffset = dstOffset,
+        .size      = size
+    };
+
+    vkCmdCopyBuffer(m_cmd, src.buffer, dst, 1, &copyRegion);
+    ++m_commandCount;
+}
+
+
+void UploadBatch::copyBufferToImage(const StagingRegion& src, VkImage dst, std::span<const VkBufferImageCopy> regions) noexcept
+{
+    std::vector<VkBufferImageCopy> copies(regions.begin(), regions.end());
+
+    for (auto& copy : copies)
+        copy.bufferOffset += src.offset;
+
+    vkCmdCopyBufferToImage(m_cmd, src.buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+    ++m_commandCount;
+}
+
+
+bool UploadBatch::transitionImage(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) noexcept
+{
+    if(!vk::recordImageTransition(m_cmd, image, format, oldLayout, newLayout, mipLevels))
+    {
+        printf("unsupported layout transition in upload batch\n");
+        return false;
+    }
+
+    ++m_commandCount;
+
+    return true;
+}
+
+
+VkCommandBuffer UploadBatch::getCommandBuffer() const noexcept
+{
+    return m_cmd;
+}
+
+
+bool UploadBatch::submit(VkQueue queue, TimelineSemaphore& timeline) noexcept
+{
+    TRACE_SCOPE("UploadBatch::submit");
+
+    if(!m_cmd || m_submitted)
+        return false;
+
+//  buffer copies carry no barrier of their own, later submissions to this queue may read them at any stage
+    const VkMemoryBarrier barrier = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext         = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if(vkEndCommandBuffer(m_cmd) != VK_SUCCESS)
+    {
+        release();
+        return false;
+    }
+
+    const uint64_t     signalValue     = timeline.peek();
+    const VkSemaphore  signalSemaphore = timeline.getHandle();
+
+    const VkTimelineSemaphoreSubmitInfo timelineInfo = 
+    {
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext                     = nullptr,
+        .waitSemaphoreValueCount   = 0,
+        .pWaitSemaphoreValues      = nullptr,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues    = &signalValue
+    };
+
+    const VkSubmitInfo submitInfo = 
+    {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = &timelineInfo,
+        .waitSemaphoreCount   = 0,
+        .pWaitSemaphores      = nullptr,
+        .pWaitDstStageMask    = nullptr,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &m_cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &signalSemaphore
+    };
+
+    if(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        release();
+        return false;
+    }
+
+    timeline.commit(signalValue);
+    m_timeline      = &timeline;
+    m_timelineValue = signalValue;
+
+    if(m_ring)
+        m_ringRegion = m_ring->close();
+
+    m_submitted = true;
+
+    return true;
+}
+
+
+bool UploadBatch::isComplete() noexcept
+{
+    if(!m_submitted)
+        return !m_cmd;
+
+    if(!m_timeline->isComplete(m_timelineValue))
+        return false;
+
+    release();
+
+    return true;
+}
+
+
+bool UploadBatch::wait() noexcept
+{
+    TRACE_SCOPE("UploadBatch::wait");
+
+    if(!m_submitted)
+        return !m_cmd;
+
+    const bool signalled = m_timeline->wait(m_timelineValue);
+    release();
+
+    return signalled;
+}
+
+
+void UploadBatch::destroy() noexcept
+{
+    if(m_submitted)
+        m_timeline->wait(m_timelineValue);
+
+    release();
+}
+
+
+bool UploadBatch::isRecording() const noexcept
+{
+    return m_cmd && !m_submitted;
+}
+
+
+uint32_t UploadBatch::getCommandCount() const noexcept
+{
+    return m_commandCount;
+}
+
+
+VkDeviceSize UploadBatch::getStagingSize() const noexcept
+{
+    return m_stagingSize;
+}
+
+
+VkDeviceSize UploadBatch::getDedicatedSize() const noexcept
+{
+    return m_dedicatedSize;
+}
+
+
+bool UploadBatch::allocateDedicated(VkDeviceSize size, StagingRegion& region) noexcept
+{
+    DedicatedBuffer dedicated = {};
+
+    if(m_allocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, dedicated.buffer, dedicated.memory) != VK_SUCCESS)
+        return false;
+
+    region.buffer = dedicated.buffer;
+    region.offset = 0;
+    region.data   = dedicated.memory.mapped;
+
+    m_dedicated.push_back(dedicated);
+    m_dedicatedSize += size;
+
+    return true;
+}
+
+
+void UploadBatch::release() noexcept
+{
+//  a batch that never reached the GPU hands its ring allocations back right away
+    if(m_ring)
+        m_ring->release(m_ringRegion ? m_ringRegion : m_ring->close());
+
+    for (auto& dedicated : m_dedicated)
+        m_allocator->destroyBuffer(dedicated.buffer, dedicated.memory);
+
+    if(m_cmd)
+        vkFreeCommandBuffers(m_device, m_pool, 1, &m_cmd);
+
+    m_dedicated.clear();
+    m_ring = nullptr;
+    m_ringRegion = 0;
+    m_timeline = nullptr;
+    m_timelineValue = 0;
+    m_cmd = nullptr;
+    m_submitted = false;
+}
\ No newline at end of file
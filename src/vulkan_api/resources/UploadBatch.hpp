@@ -0,0 +1,87 @@
+#ifndef UPLOAD_BATCH_HPP
+#define UPLOAD_BATCH_HPP
+
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/resources/StagingRing.hpp"
+#include "vulkan_api/sync/TimelineSemaphore.hpp"
+
+// Records many buffer and image uploads into one command buffer and submits them together.
+// Staging memory comes from the shared StagingRing and goes back to it once the queue's timeline reaches the value of the batch's submit,
+// uploads the ring has no room for get a staging buffer of their own that is freed at the same time.
+class UploadBatch
+{
+public:
+//  A piece of staging memory, data is written by the caller and read by the commands that take the region
+    using StagingRegion = StagingRing::Allocation;
+
+    UploadBatch() noexcept;
+
+//  Allocates a command buffer from pool and starts recording, pool must belong to the family of the submit queue.
+//  Only one batch may record from a ring at a time, without a ring every upload gets a dedicated buffer
+    bool begin(MemoryAllocator& allocator, VkDevice device, VkCommandPool pool, StagingRing* ring = nullptr) noexcept;
+
+//  The region stays valid until the batch completes
+    bool allocateStaging(VkDeviceSize size, StagingRegion& region) noexcept;
+
+//  Staging copy of data into dst, recorded right away
+    bool uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0) noexcept;
+
+    void copyBuffer(const StagingRegion& src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset = 0) noexcept;
+
+//  bufferOffset of every copy is relative to the staging region, the image must be in TRANSFER_DST_OPTIMAL
+    void copyBufferToImage(const StagingRegion& src, VkImage dst, std::span<const VkBufferImageCopy> regions) noexcept;
+
+    bool transitionImage(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1) noexcept;
+
+//  For commands the batch has no helper for, e.g. mip blits or ownership transfers
+    VkCommandBuffer getCommandBuffer() const noexcept;
+
+//  Ends recording and submits, signalling the next value of the queue's timeline
+    bool submit(VkQueue queue, TimelineSemaphore& timeline) noexcept;
+
+//  Does not block, frees the command buffer and staging memory once the timeline has reached the batch's value
+    bool isComplete() noexcept;
+
+//  Blocks until the submitted work is done and frees it
+    bool wait() noexcept;
+
+//  Waits for a submitted batch, a batch that was never submitted is discarded
+    void destroy() noexcept;
+
+    bool isRecording() const noexcept;
+
+//  Copies and transitions recorded through the helpers above
+    uint32_t     getCommandCount()   const noexcept;
+    VkDeviceSize getStagingSize()    const noexcept;
+    VkDeviceSize getDedicatedSize()  const noexcept; // the part that did not fit into the ring
+
+private:
+    struct DedicatedBuffer
+    {
+        VkBuffer                    buffer;
+        MemoryAllocator::Allocation memory;
+    };
+
+    bool allocateDedicated(VkDeviceSize size, StagingRegion& region) noexcept;
+    void release() noexcept;
+
+    MemoryAllocator*             m_allocator; // for dedicated staging buffers
+    VkDevice                     m_device;
+    VkCommandPool                m_pool;
+    VkCommandBuffer              m_cmd;
+    TimelineSemaphore*           m_timeline;
+    uint64_t                     m_timelineValue; // signalled by the submit
+    StagingRing*                 m_ring;
+    uint64_t                     m_ringRegion; // 0 - nothing sealed in the ring yet
+    std::vector<DedicatedBuffer> m_dedicated;
+    VkDeviceSize                 m_stagingSize;
+    VkDeviceSize                 m_dedicatedSize;
+    uint32_t                     m_commandCount;
+    bool                         m_submitted;
+};
+
+#endif // !UPLOAD_BATCH_HPP
\ No newline at end of file
@@ -1,11 +1,9 @@
 #include "vulkan_api/resources/VkResourceHolder.hpp"
 
 
-VkResourceHolder::VkResourceHolder(VkPhysicalDevice GPU, VkDevice device, VkQueue queue, VkCommandPool pool) noexcept:
-    m_GPU(GPU),
-    m_device(device),
-    m_queue(queue),
-    m_commandPool(pool)
+VkResourceHolder::VkResourceHolder(MemoryAllocator& allocator, UploadPath uploadPath) noexcept:
+    m_allocator(allocator),
+    m_uploadPath(uploadPath)
 {
 
 }
@@ -13,9 +11,20 @@ VkResourceHolder::VkResourceHolder(VkPhysicalDevice GPU, VkDevice device, VkQueu
 
 void VkResourceHolder::cleanup() noexcept
 {
-    for(const auto& buffer: m_buffers)
-    {
-        vkDestroyBuffer(m_device, buffer.handle, nullptr);
-        vkFreeMemory(m_device, buffer.memory, nullptr);
-    }
+    for(auto& buffer: m_buffers)
+        m_allocator.destroyBuffer(buffer.handle, buffer.memory);
+
+    m_buffers.clear();
+}
+
+
+VkResourceHolder::UploadPath VkResourceHolder::getUploadPath() const noexcept
+{
+    return m_uploadPath;
+}
+
+
+const VkResourceHolder::UploadStats& VkResourceHolder::getUploadStats() const noexcept
+{
+    return m_uploadStats;
 }
\ No newline at end of file
@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <span>
+#include <cstring>
 
+#include "utils/Trace.hpp"
 #include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+#include "vulkan_api/resources/UploadBatch.hpp"
 
 
 struct Buffer
@@ -17,46 +21,101 @@ struct Buffer
 class VkResourceHolder
 {
 public:
-    VkResourceHolder(VkPhysicalDevice GPU, VkDevice device, VkQueue queue, VkCommandPool pool) noexcept;
+    enum class UploadPath
+    {
+        Staged, // writer fills staging memory, a copy into device-local memory is recorded into the batch
+        Direct  // writer fills persistently mapped device-local memory, nothing is recorded
+    };
+
+    struct UploadStats
+    {
+        uint32_t     directCount = 0;
+        uint32_t     stagedCount = 0;
+        VkDeviceSize directBytes = 0;
+        VkDeviceSize stagedBytes = 0;
+    };
+
+//  Direct requires VulkanContext::Features::hostVisibleDeviceMemory, buffers it can not place fall back to staging
+    VkResourceHolder(MemoryAllocator& allocator, UploadPath uploadPath = UploadPath::Staged) noexcept;
 
     template <class T>
-    Buffer createBuffer(std::span<const T> rawData, VkBufferUsageFlagBits flag) noexcept
+    Buffer createBuffer(std::span<const T> rawData, VkBufferUsageFlagBits flag, UploadBatch& batch) noexcept
     {
+        return createBuffer<T>(static_cast<uint32_t>(rawData.size()), flag, batch, [rawData](T* dst)
+        {
+            memcpy(dst, rawData.data(), rawData.size_bytes());
+        });
+    }
+
+    // writer(T* dst) fills the buffer in place: its mapped memory on the direct path, otherwise the batch's staging memory
+    // with the copy into the device-local buffer recorded into batch. Either way the buffer may be used by any submission
+    // to the same queue after the batch
+    template <class T, class Writer>
+    Buffer createBuffer(uint32_t count, VkBufferUsageFlags usage, UploadBatch& batch, Writer&& writer) noexcept
+    {
+        TRACE_SCOPE("VkResourceHolder::createBuffer");
+
         BufferData bufferData;
-        bufferData.size = rawData.size();
-        const VkDeviceSize bufferSize = sizeof(T) * rawData.size();
+        bufferData.size = count;
+        const VkDeviceSize bufferSize = sizeof(T) * count;
 
-        VkDeviceMemory stagingBufferMemory;
-        VkBuffer stagingBuffer = vk::createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBufferMemory, m_device, m_GPU);
+        if(m_uploadPath == UploadPath::Direct)
+        {// host writes are made visible to the device by the next queue submission
+            constexpr VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-        if(!stagingBuffer)
-            return {};
+            if (m_allocator.createBuffer(bufferSize, usage, directFlags, bufferData.handle, bufferData.memory) == VK_SUCCESS)
+            {
+//              over budget the allocator falls back to memory without DEVICE_LOCAL, such a buffer is staged instead
+                const VkMemoryPropertyFlags placed = m_allocator.getMemoryProperties().memoryTypes[bufferData.memory.memoryType].propertyFlags;
+
+                if((placed & directFlags) != directFlags)
+                {
+                    m_allocator.destroyBuffer(bufferData.handle, bufferData.memory);
+                    bufferData.handle = nullptr;
+                    bufferData.memory = {};
+                }
+            }
 
-        struct BufferMemoryDeleter
-        {
-            ~BufferMemoryDeleter() 
+            if(bufferData.handle)
             {
-                vkDestroyBuffer(device, buffer, nullptr);
-                vkFreeMemory(device, memory, nullptr);
+                writer(static_cast<T*>(bufferData.memory.mapped));
+                m_buffers.push_back(bufferData);
+                ++m_uploadStats.directCount;
+                m_uploadStats.directBytes += bufferSize;
+
+                return { bufferData.handle, bufferData.size };
             }
+        }
 
-            VkDeviceMemory memory = nullptr;
-            VkBuffer buffer = nullptr;
-            VkDevice device = nullptr;
-        };
+        UploadBatch::StagingRegion staging;
+
+        if(!batch.allocateStaging(bufferSize, staging))
+            return {};
 
-        BufferMemoryDeleter guard = { stagingBufferMemory, stagingBuffer, m_device };
+        writer(static_cast<T*>(staging.data));
 
-        if (void* ptr; vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &ptr) == VK_SUCCESS)
+        if (m_allocator.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferData.handle, bufferData.memory) == VK_SUCCESS)
         {
-            memcpy(ptr, rawData.data(), (size_t)bufferSize);
-            vkUnmapMemory(m_device, stagingBufferMemory);
+            batch.copyBuffer(staging, bufferData.handle, bufferSize);
+            m_buffers.push_back(bufferData);
+            ++m_uploadStats.stagedCount;
+            m_uploadStats.stagedBytes += bufferSize;
+
+            return { bufferData.handle, bufferData.size };
         }
-        else return {};
 
-        if (bufferData.handle = vk::createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | flag, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferData.memory, m_device, m_GPU))
+        return {};
+    }
+
+    // Uninitialized device-local buffer for data produced on the GPU
+    template <class T>
+    Buffer createBuffer(uint32_t count, VkBufferUsageFlags usage) noexcept
+    {
+        BufferData bufferData;
+        bufferData.size = count;
+
+        if (m_allocator.createBuffer(sizeof(T) * count, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferData.handle, bufferData.memory) == VK_SUCCESS)
         {
-            vk::copyBuffer(stagingBuffer, bufferData.handle, bufferSize, m_device, m_commandPool, m_queue);
             m_buffers.push_back(bufferData);
 
             return { bufferData.handle, bufferData.size };
@@ -67,17 +126,19 @@ public:
 
     void cleanup() noexcept;
 
+    UploadPath         getUploadPath()  const noexcept;
+    const UploadStats& getUploadStats() const noexcept;
+
 private:
-    VkPhysicalDevice m_GPU;
-    VkDevice         m_device;
-    VkQueue          m_queue;
-    VkCommandPool    m_commandPool;
+    MemoryAllocator& m_allocator;
+    UploadPath       m_uploadPath;
+    UploadStats      m_uploadStats;
 
     struct BufferData
     {
-        VkBuffer       handle = nullptr;
-        VkDeviceMemory memory = nullptr;
-        uint32_t       size   = 0;
+        VkBuffer                    handle = nullptr;
+        MemoryAllocator::Allocation memory;
+        uint32_t                    size   = 0;
     };
 
     std::vector<BufferData> m_buffers;
@@ -4,13 +4,14 @@
 
 
 SyncManager::SyncManager() noexcept:
-    currentFrame(0)
+    currentFrame(0),
+    m_dedicatedTransferQueue(false)
 {
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
     {
         imageAvailableSemaphores[i] = nullptr;
         renderFinishedSemaphores[i] = nullptr;
-        inFlightFences[i] = nullptr;
+        frameValues[i] = 0;
     }
 }
 
@@ -18,25 +19,28 @@ SyncManager::SyncManager() noexcept:
 SyncManager::~SyncManager() = default;
 
 
-bool SyncManager::create(VkDevice logicalDevice) noexcept
+bool SyncManager::create(VkDevice logicalDevice, bool dedicatedTransferQueue) noexcept
 {
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
     {
         if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(logicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+            vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS)
         {
             return false;
         }
     }
 
+    m_dedicatedTransferQueue = dedicatedTransferQueue;
+
+    if (!graphicsTimeline.create(logicalDevice))
+        return false;
+
+    if (m_dedicatedTransferQueue && !transferTimeline.create(logicalDevice))
+        return false;
+
     return true;
 }
 
@@ -47,6 +51,20 @@ void SyncManager::destroy(VkDevice logicalDevice) noexcept
     {
         vkDestroySemaphore(logicalDevice, renderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(logicalDevice, imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(logicalDevice, inFlightFences[i], nullptr);
     }
+
+    graphicsTimeline.destroy();
+    transferTimeline.destroy();
+}
+
+
+bool SyncManager::waitForFrame(uint32_t frame) noexcept
+{
+    return graphicsTimeline.wait(frameValues[frame]);
+}
+
+
+TimelineSemaphore& SyncManager::getTransferTimeline() noexcept
+{
+    return m_dedicatedTransferQueue ? transferTimeline : graphicsTimeline;
 }
\ No newline at end of file
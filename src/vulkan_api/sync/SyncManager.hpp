@@ -4,21 +4,36 @@
 #include <array>
 
 #include "vulkan_api/utils/Defines.hpp"
+#include "vulkan_api/sync/TimelineSemaphore.hpp"
 
-
+// One timeline semaphore per queue: every submit to the graphics queue signals the next value of graphicsTimeline,
+// a frame slot remembers the value of its last submit and the CPU waits for exactly that value before reusing the slot.
+// The swapchain still needs binary semaphores for acquire and present.
 class SyncManager
 {
 public:
     SyncManager() noexcept;
     ~SyncManager();
 
-    bool create(struct VkDevice_T* logicalDevice) noexcept;
+//  The transfer timeline only exists for a dedicated transfer queue, otherwise transfers are submitted to the graphics queue
+    bool create(struct VkDevice_T* logicalDevice, bool dedicatedTransferQueue) noexcept;
     void destroy(struct VkDevice_T* logicalDevice) noexcept;
 
+//  Blocks until the GPU finished the last submit of the frame slot
+    bool waitForFrame(uint32_t frame) noexcept;
+
+//  The timeline of the queue transfers are submitted to, graphicsTimeline when it is the same queue
+    TimelineSemaphore& getTransferTimeline() noexcept;
+
     std::array<struct VkSemaphore_T*, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores;
     std::array<struct VkSemaphore_T*, MAX_FRAMES_IN_FLIGHT> renderFinishedSemaphores;
-    std::array<struct VkFence_T*, MAX_FRAMES_IN_FLIGHT>     inFlightFences;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT>              frameValues; // graphicsTimeline value of each slot's last submit, 0 - never submitted
+    TimelineSemaphore                                       graphicsTimeline;
+    TimelineSemaphore                                       transferTimeline;
     uint32_t                                                currentFrame;
+
+private:
+    bool m_dedicatedTransferQueue;
 };
 
 #endif // !SYNC_MANAGER_HPP
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <algorithm>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/sync/TimelineSemaphore.hpp"
+
+
+TimelineSemaphore::TimelineSemaphore() noexcept:
+    m_device(nullptr),
+    m_handle(nullptr),
+    m_lastValue(0),
+    m_completedValue(0)
+{
+
+}
+
+
+bool TimelineSemaphore::create(VkDevice device) noexcept
+{
+    const VkSemaphoreTypeCreateInfo typeInfo = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .pNext         = nullptr,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0
+    };
+
+    const VkSemaphoreCreateInfo semaphoreInfo = 
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &typeInfo,
+        .flags = 0
+    };
+
+    m_device         = device;
+    m_lastValue      = 0;
+    m_completedValue = 0;
+
+    return vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_handle) == VK_SUCCESS;
+}
+
+
+void TimelineSemaphore::destroy() noexcept
+{
+    if(m_handle)
+        vkDestroySemaphore(m_device, m_handle, nullptr);
+
+    m_handle = nullptr;
+}
+
+
+uint64_t TimelineSemaphore::peek() const noexcept
+{
+    return m_lastValue + 1;
+}
+
+
+void TimelineSemaphore::commit(uint64_t value) noexcept
+{
+    m_lastValue = value;
+}
+
+
+uint64_t TimelineSemaphore::getLastValue() const noexcept
+{
+    return m_lastValue;
+}
+
+
+uint64_t TimelineSemaphore::getCompletedValue() noexcept
+{
+    uint64_t value = 0;
+
+    if(vkGetSemaphoreCounterValue(m_device, m_handle, &value) != VK_SUCCESS)
+        return m_completedValue;
+
+    return markCompleted(value);
+}
+
+
+bool TimelineSemaphore::isComplete(uint64_t value) noexcept
+{
+    return value <= m_completedValue || value <= getCompletedValue();
+}
+
+
+bool TimelineSemaphore::wait(uint64_t value, uint64_t timeout) noexcept
+{
+    if(value <= m_completedValue)
+        return true;
+
+    TRACE_SCOPE("TimelineSemaphore::wait");
+
+    const VkSemaphoreWaitInfo waitInfo = 
+    {
+        .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .pNext          = nullptr,
+        .flags          = 0,
+        .semaphoreCount = 1,
+        .pSemaphores    = &m_handle,
+        .pValues        = &value
+    };
+
+    if(vkWaitSemaphores(m_device, &waitInfo, timeout) != VK_SUCCESS)
+        return false;
+
+    markCompleted(value);
+
+    return true;
+}
+
+
+VkSemaphore TimelineSemaphore::getHandle() const noexcept
+{
+    return m_handle;
+}
+
+
+uint64_t TimelineSemaphore::markCompleted(uint64_t value) noexcept
+{
+//  the counter only grows, when another thread already saw a larger value it is kept
+    uint64_t completed = m_completedValue;
+
+    while (completed < value && !m_completedValue.compare_exchange_weak(completed, value));
+
+    return std::max(completed, value);
+}
\ No newline at end of file
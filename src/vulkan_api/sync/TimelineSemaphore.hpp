@@ -0,0 +1,49 @@
+#ifndef TIMELINE_SEMAPHORE_HPP
+#define TIMELINE_SEMAPHORE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+// A timeline semaphore (Vulkan 1.2 core) counting the submissions to one queue.
+// Every submit signals the next value of the counter, whatever depends on that submit - a frame, an upload batch,
+// a resource waiting to be destroyed - keeps the value and is done once the counter has reached it.
+// Values must be signalled in the order they were handed out, so the thread that submits peeks the next value for the submit
+// and commits it only once vkQueueSubmit succeeded - a failed submit leaves the counter where it was.
+class TimelineSemaphore
+{
+public:
+    TimelineSemaphore() noexcept;
+
+    bool create(VkDevice device) noexcept;
+    void destroy() noexcept;
+
+//  The value the next submit signals, it is not handed out before commit()
+    uint64_t peek() const noexcept;
+
+//  Called with the peeked value after its submit succeeded
+    void commit(uint64_t value) noexcept;
+
+//  The last committed value, 0 before the first submit. Work submitted so far is done once the counter reaches it
+    uint64_t getLastValue() const noexcept;
+
+//  The counter as the device reports it, never blocks
+    uint64_t getCompletedValue() noexcept;
+
+//  Asks the device only when the value is past the last completed value seen
+    bool isComplete(uint64_t value) noexcept;
+    bool wait(uint64_t value, uint64_t timeout = UINT64_MAX) noexcept;
+
+    VkSemaphore getHandle() const noexcept;
+
+private:
+    uint64_t markCompleted(uint64_t value) noexcept;
+
+    VkDevice              m_device;
+    VkSemaphore           m_handle;
+    std::atomic<uint64_t> m_lastValue;
+    std::atomic<uint64_t> m_completedValue;
+};
+
+#endif // !TIMELINE_SEMAPHORE_HPP
\ No newline at end of file
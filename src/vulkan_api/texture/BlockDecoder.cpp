@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "vulkan_api/texture/BlockDecoder.hpp"
+
+
+namespace
+{
+    enum class Codec
+    {
+        None,
+        BC1,
+        BC1A,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+        ETC2,
+        ETC2A1,
+        ETC2A8
+    };
+
+//  4x4 texels, row by row
+    using Texels = std::array<std::array<uint8_t, 4>, 16>;
+
+    constexpr std::array<std::array<int32_t, 2>, 8> ETC_MODIFIERS = 
+    {{
+        { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+    }};
+
+    constexpr std::array<int32_t, 8> ETC_DISTANCES = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+    constexpr std::array<std::array<int32_t, 8>, 16> EAC_MODIFIERS = 
+    {{
+        { -3, -6,  -9, -15, 2, 5, 8, 14 },
+        { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5,  -8, -13, 1, 4, 7, 12 },
+        { -2, -4,  -6, -13, 1, 3, 5, 12 },
+        { -3, -6,  -8, -12, 2, 5, 7, 11 },
+        { -3, -7,  -9, -11, 2, 6, 8, 10 },
+        { -4, -7,  -8, -11, 3, 6, 7, 10 },
+        { -3, -5,  -8, -11, 2, 4, 7, 10 },
+        { -2, -6,  -8, -10, 1, 5, 7,  9 },
+        { -2, -5,  -8, -10, 1, 4, 7,  9 },
+        { -2, -4,  -8, -10, 1, 3, 7,  9 },
+        { -2, -5,  -7, -10, 1, 4, 6,  9 },
+        { -3, -4,  -7, -10, 2, 3, 6,  9 },
+        { -1, -2,  -3, -10, 0, 1, 2,  9 },
+        { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+        { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+    }};
+
+//  ASTC_4x4 to ASTC_12x12, each with a UNORM and an SRGB enumerant
+    constexpr std::array<std::array<uint32_t, 2>, 14> ASTC_BLOCKS = 
+    {{
+        { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    }};
+
+
+    Codec get_codec(VkFormat format) noexcept
+    {
+        switch (format)
+        {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:        return Codec::BC1;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:       return Codec::BC1A;
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:            return Codec::BC2;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:            return Codec::BC3;
+            case VK_FORMAT_BC4_UNORM_BLOCK:           return Codec::BC4;
+            case VK_FORMAT_BC5_UNORM_BLOCK:           return Codec::BC5;
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:    return Codec::ETC2;
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:  return Codec::ETC2A1;
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:  return Codec::ETC2A8;
+            default:                                  return Codec::None;
+        }
+    }
+
+
+    uint8_t clamp_byte(int32_t value) noexcept
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+
+    uint64_t read_le64(const uint8_t* data) noexcept
+    {
+        uint64_t value = 0;
+
+        for (uint32_t i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+
+        return value;
+    }
+
+
+    uint64_t read_be64(const uint8_t* data) noexcept
+    {
+        uint64_t value = 0;
+
+        for (uint32_t i = 0; i < 8; ++i)
+            value = (value << 8) | data[i];
+
+        return value;
+    }
+
+
+//  A 565 endpoint expanded to 8 bits per channel
+    std::array<int32_t, 3> unpack_565(uint32_t color) noexcept
+    {
+        const uint32_t r = (color >> 11) & 31;
+        const uint32_t g = (color >> 5) & 63;
+        const uint32_t b = color & 31;
+
+        return { static_cast<int32_t>((r << 3) | (r >> 2)), static_cast<int32_t>((g << 2) | (g >> 4)), static_cast<int32_t>((b << 3) | (b >> 2)) };
+    }
+
+
+//  BC1 and the color half of BC2 and BC3, which always use four colors
+    void decode_bc1(const uint8_t* block, Texels& texels, bool fourColors, bool punchthrough) noexcept
+    {
+        const uint32_t color0  = block[0] | (block[1] << 8);
+        const uint32_t color1  = block[2] | (block[3] << 8);
+        const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+        const auto c0 = unpack_565(color0);
+        const auto c1 = unpack_565(color1);
+
+        std::array<std::array<uint8_t, 4>, 4> palette;
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            palette[0][i] = static_cast<uint8_t>(c0[i]);
+            palette[1][i] = static_cast<uint8_t>(c1[i]);
+
+            if(fourColors || color0 > color1)
+            {
+                palette[2][i] = static_cast<uint8_t>((2 * c0[i] + c1[i]) / 3);
+                palette[3][i] = static_cast<uint8_t>((c0[i] + 2 * c1[i]) / 3);
+            }
+            else
+            {
+                palette[2][i] = static_cast<uint8_t>((c0[i] + c1[i]) / 2);
+                palette[3][i] = 0;
+            }
+        }
+
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = (!fourColors && color0 <= color1 && punchthrough) ? 0 : 255;
+
+        for (uint32_t i = 0; i < 16; ++i)
+            texels[i] = palette[(indices >> (2 * i)) & 3];
+    }
+
+
+//  The interpolated single channel of BC3 alpha, BC4 and BC5
+    void decode_bc_channel(const uint8_t* block, Texels& texels, uint32_t channel) noexcept
+    {
+        const int32_t a0 = block[0];
+        const int32_t a1 = block[1];
+        const uint64_t indices = read_le64(block) >> 16;
+
+        std::array<uint8_t, 8> palette = { static_cast<uint8_t>(a0), static_cast<uint8_t>(a1) };
+
+        if(a0 > a1)
+        {
+            for (int32_t i = 2; i < 8; ++i)
+                palette[i] = static_cast<uint8_t>(((8 - i) * a0 + (i - 1) * a1) / 7);
+        }
+        else
+        {
+            for (int32_t i = 2; i < 6; ++i)
+                palette[i] = static_cast<uint8_t>(((6 - i) * a0 + (i - 1) * a1) / 5);
+
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for (uint32_t i = 0; i < 16; ++i)
+            texels[i][channel] = palette[(indices >> (3 * i)) & 7];
+    }
+
+
+    void decode_bc2_alpha(const uint8_t* block, Texels& texels) noexcept
+    {
+        const uint64_t alpha = read_le64(block);
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            const uint32_t value = (alpha >> (4 * i)) & 15;
+            texels[i][3] = static_cast<uint8_t>((value << 4) | value);
+        }
+    }
+
+
+//  ETC2 RGB, with punchthrough the differential bit is the opaque bit and there is no individual mode
+    void decode_etc2(const uint8_t* block, Texels& texels, bool punchthrough) noexcept
+    {
+        const uint64_t bits = read_be64(block);
+        const bool differential = punchthrough || ((bits >> 33) & 1);
+        const bool opaque = !punchthrough || ((bits >> 33) & 1);
+        const bool flip = (bits >> 32) & 1;
+
+    //  pixel indices run column by column, the high bits of all 16 come first
+        auto pixel_index = [bits](uint32_t x, uint32_t y)
+        {
+            const uint32_t i = x * 4 + y;
+            return static_cast<uint32_t>((((bits >> (i + 16)) & 1) << 1) | ((bits >> i) & 1));
+        };
+
+        auto extend4 = [](uint64_t v) { return static_cast<int32_t>(((v & 15) << 4) | (v & 15)); };
+        auto extend5 = [](uint64_t v) { return static_cast<int32_t>(((v & 31) << 3) | ((v & 31) >> 2)); };
+        auto extend6 = [](uint64_t v) { return static_cast<int32_t>(((v & 63) << 2) | ((v & 63) >> 4)); };
+        auto extend7 = [](uint64_t v) { return static_cast<int32_t>(((v & 127) << 1) | ((v & 127) >> 6)); };
+
+        auto write_paint = [&](const std::array<std::array<int32_t, 3>, 4>& paint)
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const uint32_t index = pixel_index(x, y);
+                    auto& texel = texels[y * 4 + x];
+
+                    if(!opaque && index == 2)
+                        texel = { 0, 0, 0, 0 };
+                    else
+                        texel = { clamp_byte(paint[index][0]), clamp_byte(paint[index][1]), clamp_byte(paint[index][2]), 255 };
+                }
+            }
+        };
+
+        std::array<std::array<int32_t, 3>, 2> base;
+
+        if(!differential)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                base[0][c] = extend4(bits >> (60 - 8 * c));
+                base[1][c] = extend4(bits >> (56 - 8 * c));
+            }
+        }
+        else
+        {
+            std::array<int32_t, 3> second;
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                const int32_t value = static_cast<int32_t>((bits >> (59 - 8 * c)) & 31);
+                const int32_t delta = static_cast<int32_t>(((bits >> (56 - 8 * c)) & 7) ^ 4) - 4;
+                second[c] = value + delta;
+                base[0][c] = extend5(static_cast<uint64_t>(value));
+            }
+
+            if(second[0] < 0 || second[0] > 31)
+            {// T mode
+                const int32_t distance = ETC_DISTANCES[(((bits >> 34) & 3) << 1) | ((bits >> 32) & 1)];
+                const std::array<int32_t, 3> c1 = { extend4((((bits >> 59) & 3) << 2) | ((bits >> 56) & 3)), extend4(bits >> 52), extend4(bits >> 48) };
+                const std::array<int32_t, 3> c2 = { extend4(bits >> 44), extend4(bits >> 40), extend4(bits >> 36) };
+
+                write_paint({{ c1, { c2[0] + distance, c2[1] + distance, c2[2] + distance }, c2, { c2[0] - distance, c2[1] - distance, c2[2] - distance } }});
+                return;
+            }
+
+            if(second[1] < 0 || second[1] > 31)
+            {// H mode, the order of the colors holds the lowest distance bit
+                const uint64_t r1 = (bits >> 59) & 15;
+                const uint64_t g1 = (((bits >> 56) & 7) << 1) | ((bits >> 52) & 1);
+                const uint64_t b1 = (((bits >> 51) & 1) << 3) | ((bits >> 47) & 7);
+                const uint64_t r2 = (bits >> 43) & 15;
+                const uint64_t g2 = (bits >> 39) & 15;
+                const uint64_t b2 = (bits >> 35) & 15;
+                const uint64_t order = (((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2)) ? 1 : 0;
+                const int32_t distance = ETC_DISTANCES[(((bits >> 34) & 1) << 2) | (((bits >> 32) & 1) << 1) | order];
+
+                const std::array<int32_t, 3> c1 = { extend4(r1), extend4(g1), extend4(b1) };
+                const std::array<int32_t, 3> c2 = { extend4(r2), extend4(g2), extend4(b2) };
+
+                write_paint({{ { c1[0] + distance, c1[1] + distance, c1[2] + distance }, { c1[0] - distance, c1[1] - distance, c1[2] - distance },
+                               { c2[0] + distance, c2[1] + distance, c2[2] + distance }, { c2[0] - distance, c2[1] - distance, c2[2] - distance } }});
+                return;
+            }
+
+            if(second[2] < 0 || second[2] > 31)
+            {// planar mode, always opaque
+                const int32_t ro = extend6(bits >> 57);
+                const int32_t go = extend7((((bits >> 56) & 1) << 6) | ((bits >> 49) & 63));
+                const int32_t bo = extend6((((bits >> 48) & 1) << 5) | (((bits >> 43) & 3) << 3) | ((bits >> 39) & 7));
+                const int32_t rh = extend6((((bits >> 34) & 31) << 1) | ((bits >> 32) & 1));
+                const int32_t gh = extend7(bits >> 25);
+                const int32_t bh = extend6(bits >> 19);
+                const int32_t rv = extend6(bits >> 13);
+                const int32_t gv = extend7(bits >> 6);
+                const int32_t bv = extend6(bits);
+
+                for (int32_t y = 0; y < 4; ++y)
+                {
+                    for (int32_t x = 0; x < 4; ++x)
+                    {
+                        texels[y * 4 + x] = 
+                        {
+                            clamp_byte((x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2),
+                            clamp_byte((x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2),
+                            clamp_byte((x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2),
+                            255
+                        };
+                    }
+                }
+
+                return;
+            }
+
+            for (uint32_t c = 0; c < 3; ++c)
+                base[1][c] = extend5(static_cast<uint64_t>(second[c]));
+        }
+
+        const std::array<uint32_t, 2> tables = { static_cast<uint32_t>((bits >> 37) & 7), static_cast<uint32_t>((bits >> 34) & 7) };
+
+        for (uint32_t y = 0; y < 4; ++y)
+        {
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                const uint32_t subblock = flip ? (y >= 2) : (x >= 2);
+                const uint32_t index = pixel_index(x, y);
+                auto& texel = texels[y * 4 + x];
+
+                if(!opaque && index == 2)
+                {
+                    texel = { 0, 0, 0, 0 };
+                    continue;
+                }
+
+            //  0 and 2 add and subtract the small modifier, 1 and 3 the large one, without opacity the small one is 0
+                const int32_t magnitude = (index & 1) ? ETC_MODIFIERS[tables[subblock]][1] : (opaque ? ETC_MODIFIERS[tables[subblock]][0] : 0);
+                const int32_t modifier = (index & 2) ? -magnitude : magnitude;
+
+                texel = { clamp_byte(base[subblock][0] + modifier), clamp_byte(base[subblock][1] + modifier), clamp_byte(base[subblock][2] + modifier), 255 };
+            }
+        }
+    }
+
+
+    void decode_eac_alpha(const uint8_t* block, Texels& texels) noexcept
+    {
+        const int32_t base = block[0];
+        const int32_t multiplier = block[1] >> 4;
+        const auto& modifiers = EAC_MODIFIERS[block[1] & 15];
+        const uint64_t bits = read_be64(block);
+
+        for (uint32_t x = 0; x < 4; ++x)
+            for (uint32_t y = 0; y < 4; ++y)
+                texels[y * 4 + x][3] = clamp_byte(base + modifiers[(bits >> (45 - 3 * (x * 4 + y))) & 7] * multiplier);
+    }
+}
+
+
+
+BEGIN_NAMESPACE_VK
+
+
+FormatBlock getFormatBlock(VkFormat format) noexcept
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            return { 1, 1, 4 };
+
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            return { 4, 4, 8 };
+
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+            return { 4, 4, 16 };
+
+        default:
+            break;
+    }
+
+    if(format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+    {
+        const auto& extent = ASTC_BLOCKS[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+        return { extent[0], extent[1], 16 };
+    }
+
+    return { 1, 1, 0 };
+}
+
+
+VkDeviceSize getLevelSize(VkFormat format, uint32_t width, uint32_t height) noexcept
+{
+    const FormatBlock block = getFormatBlock(format);
+
+    return static_cast<VkDeviceSize>((width + block.width - 1) / block.width) * ((height + block.height - 1) / block.height) * block.bytes;
+}
+
+
+VkFormat getDecodedFormat(VkFormat format) noexcept
+{
+    switch (format)
+    {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+
+        default:
+            return (get_codec(format) != Codec::None) ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_UNDEFINED;
+    }
+}
+
+
+bool decodeBlocks(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba) noexcept
+{
+    const Codec codec = get_codec(format);
+
+    if(codec == Codec::None)
+        return false;
+
+    const uint32_t blockBytes = getFormatBlock(format).bytes;
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+
+    Texels texels;
+
+    for (uint32_t by = 0; by < blocksY; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksX; ++bx)
+        {
+            const uint8_t* block = blocks + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+
+            texels.fill({ 0, 0, 0, 255 });
+
+            switch (codec)
+            {
+                case Codec::BC1:    decode_bc1(block, texels, false, false); break;
+                case Codec::BC1A:   decode_bc1(block, texels, false, true); break;
+                case Codec::BC2:    decode_bc1(block + 8, texels, true, false); decode_bc2_alpha(block, texels); break;
+                case Codec::BC3:    decode_bc1(block + 8, texels, true, false); decode_bc_channel(block, texels, 3); break;
+                case Codec::BC4:    decode_bc_channel(block, texels, 0); break;
+                case Codec::BC5:    decode_bc_channel(block, texels, 0); decode_bc_channel(block + 8, texels, 1); break;
+                case Codec::ETC2:   decode_etc2(block, texels, false); break;
+                case Codec::ETC2A1: decode_etc2(block, texels, true); break;
+                case Codec::ETC2A8: decode_etc2(block + 8, texels, false); decode_eac_alpha(block, texels); break;
+                default: break;
+            }
+
+        //  blocks hang over the edges of levels that are not a multiple of 4
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    memcpy(rgba + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4 + x) * 4, texels[y * 4 + x].data(), 4);
+        }
+    }
+
+    return true;
+}
+
+
+END_NAMESPACE_VK
\ No newline at end of file
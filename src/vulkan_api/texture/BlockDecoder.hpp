@@ -0,0 +1,35 @@
+#ifndef BLOCK_DECODER_HPP
+#define BLOCK_DECODER_HPP
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/utils/Defines.hpp"
+
+BEGIN_NAMESPACE_VK
+
+
+struct FormatBlock
+{
+    uint32_t width  = 1;
+    uint32_t height = 1;
+    uint32_t bytes  = 0; // 0 - a format textures can not be loaded in
+};
+
+//  Texel block of the uncompressed RGBA8 and the BCn, ETC2 and ASTC formats
+FormatBlock getFormatBlock(VkFormat format) noexcept;
+
+VkDeviceSize getLevelSize(VkFormat format, uint32_t width, uint32_t height) noexcept;
+
+//  The RGBA8 format decodeBlocks() writes for format, VK_FORMAT_UNDEFINED when format can not be decoded on the CPU.
+//  BC1-BC5 and ETC2 are decoded, BC6H, BC7 and ASTC are not
+VkFormat getDecodedFormat(VkFormat format) noexcept;
+
+//  Decodes one level into tightly packed RGBA8, channels a format does not have are 0 for color and 255 for alpha
+bool decodeBlocks(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba) noexcept;
+
+
+END_NAMESPACE_VK
+
+#endif // !BLOCK_DECODER_HPP
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/texture/BlockDecoder.hpp"
+#include "vulkan_api/texture/Ktx2Image.hpp"
+
+
+namespace
+{
+    constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    struct Ktx2Header
+    {
+        uint8_t  identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct Ktx2Level
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80 && sizeof(Ktx2Level) == 24, "KTX2 headers are read in place");
+
+
+    VkBufferImageCopy make_copy_region(VkDeviceSize offset, uint32_t level, uint32_t width, uint32_t height) noexcept
+    {
+        return VkBufferImageCopy
+        {
+            .bufferOffset      = offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageOffset       = { 0, 0, 0 },
+            .imageExtent       = { width, height, 1 }
+        };
+    }
+}
+
+
+
+Ktx2Image::Ktx2Image() noexcept:
+    m_format(VK_FORMAT_UNDEFINED),
+    m_storedFormat(VK_FORMAT_UNDEFINED),
+    m_width(0),
+    m_height(0),
+    m_mipLevels(0)
+{
+
+}
+
+
+bool Ktx2Image::isKtx2File(const char* filepath) noexcept
+{
+    return std::string_view(filepath).ends_with(".ktx2");
+}
+
+
+bool Ktx2Image::loadFromFile(const char* filepath) noexcept
+{
+    TRACE_SCOPE("Ktx2Image::loadFromFile");
+
+    std::ifstream stream;
+    stream.open(filepath, std::ios::ate | std::ios::binary);
+
+    if (!stream.is_open())
+    {
+        printf("failed to open %s\n", filepath);
+        return false;
+    }
+
+    std::vector<uint8_t> file(static_cast<size_t>(stream.tellg()));
+
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(file.data()), file.size());
+
+    if (!stream || !parse(file.data(), file.size()))
+    {
+        printf("failed to read %s\n", filepath);
+        return false;
+    }
+
+//  moving the vector keeps its buffer, the data still points into it
+    m_storage = std::move(file);
+
+    return true;
+}
+
+
+bool Ktx2Image::loadFromMemory(const void* data, size_t size) noexcept
+{
+    m_storage.clear();
+    m_data = {};
+
+    return parse(static_cast<const uint8_t*>(data), size);
+}
+
+
+bool Ktx2Image::parse(const uint8_t* bytes, size_t size) noexcept
+{
+    Ktx2Header header;
+
+    if(size < sizeof(header))
+        return false;
+
+    memcpy(&header, bytes, sizeof(header));
+
+    if(memcmp(header.identifier, KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) != 0)
+        return false;
+
+    const VkFormat format = static_cast<VkFormat>(header.vkFormat);
+    const vk::FormatBlock block = vk::getFormatBlock(format);
+
+    if(block.bytes == 0 || header.supercompressionScheme != 0)
+    {
+        printf("KTX2 format %u with supercompression %u is not supported\n", header.vkFormat, header.supercompressionScheme);
+        return false;
+    }
+
+    if(header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+    {
+        printf("only 2D KTX2 textures are supported\n");
+        return false;
+    }
+
+//  a level count of 0 asks the loader to generate mips, the single stored level is used as it is
+    const uint32_t levelCount = std::max(header.levelCount, 1U);
+
+    if(levelCount > vk::getMipLevelCount(header.pixelWidth, header.pixelHeight) || size < sizeof(header) + levelCount * sizeof(Ktx2Level))
+        return false;
+
+    std::vector<VkBufferImageCopy> regions(levelCount);
+    std::vector<Ktx2Level> levels(levelCount);
+    memcpy(levels.data(), bytes + sizeof(header), levelCount * sizeof(Ktx2Level));
+
+    uint64_t first = size;
+    uint64_t last  = 0;
+
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const VkDeviceSize levelSize = vk::getLevelSize(format, std::max(header.pixelWidth >> level, 1U), std::max(header.pixelHeight >> level, 1U));
+
+        if(levels[level].byteLength < levelSize || levels[level].byteOffset > size || size - levels[level].byteOffset < levelSize)
+            return false;
+
+//      KTX2 aligns every level to lcm(block size, 4), as the copy regions require
+        if(levels[level].byteOffset % block.bytes != 0 || levels[level].byteOffset % 4 != 0)
+            return false;
+
+        first = std::min(first, levels[level].byteOffset);
+        last  = std::max(last, levels[level].byteOffset + levelSize);
+    }
+
+//  the levels are uploaded in place, the smallest one stored first, so the data is the range covering all of them
+    for (uint32_t level = 0; level < levelCount; ++level)
+        regions[level] = make_copy_region(levels[level].byteOffset - first, level, std::max(header.pixelWidth >> level, 1U), std::max(header.pixelHeight >> level, 1U));
+
+    m_data         = std::span<const uint8_t>(bytes + first, static_cast<size_t>(last - first));
+    m_regions      = std::move(regions);
+    m_format       = format;
+    m_storedFormat = format;
+    m_width        = header.pixelWidth;
+    m_height       = header.pixelHeight;
+    m_mipLevels    = levelCount;
+
+    return true;
+}
+
+
+bool Ktx2Image::selectFormat(VkPhysicalDevice GPU) noexcept
+{
+    TRACE_SCOPE("Ktx2Image::selectFormat");
+
+    const std::array<VkFormat, 1> candidates = { m_storedFormat };
+
+    if(vk::findSupportedFormat(candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT, GPU) != VK_FORMAT_UNDEFINED)
+    {
+        m_format = m_storedFormat;
+        return true;
+    }
+
+    const VkFormat decodedFormat = vk::getDecodedFormat(m_storedFormat);
+
+    if(decodedFormat == VK_FORMAT_UNDEFINED)
+    {
+        printf("texture format %d is not supported by the GPU and can not be decoded\n", m_storedFormat);
+        return false;
+    }
+
+    std::vector<VkBufferImageCopy> regions(m_regions.size());
+    VkDeviceSize decodedSize = 0;
+
+    for (size_t level = 0; level < m_regions.size(); ++level)
+    {
+        regions[level] = m_regions[level];
+        regions[level].bufferOffset = decodedSize;
+        decodedSize += static_cast<VkDeviceSize>(m_regions[level].imageExtent.width) * m_regions[level].imageExtent.height * 4;
+    }
+
+    std::vector<uint8_t> decoded(static_cast<size_t>(decodedSize));
+
+    for (size_t level = 0; level < m_regions.size(); ++level)
+    {
+        const VkExtent3D& extent = m_regions[level].imageExtent;
+        vk::decodeBlocks(m_storedFormat, m_data.data() + m_regions[level].bufferOffset, extent.width, extent.height, decoded.data() + regions[level].bufferOffset);
+    }
+
+    m_storage = std::move(decoded);
+    m_data    = m_storage;
+    m_regions = std::move(regions);
+    m_format  = decodedFormat;
+
+    return true;
+}
+
+
+VkFormat Ktx2Image::getFormat() const noexcept
+{
+    return m_format;
+}
+
+
+VkFormat Ktx2Image::getStoredFormat() const noexcept
+{
+    return m_storedFormat;
+}
+
+
+uint32_t Ktx2Image::getWidth() const noexcept
+{
+    return m_width;
+}
+
+
+uint32_t Ktx2Image::getHeight() const noexcept
+{
+    return m_height;
+}
+
+
+uint32_t Ktx2Image::getMipLevels() const noexcept
+{
+    return m_mipLevels;
+}
+
+
+bool Ktx2Image::isDecoded() const noexcept
+{
+    return m_format != m_storedFormat;
+}
+
+
+std::span<const uint8_t> Ktx2Image::getData() const noexcept
+{
+    return m_data;
+}
+
+
+const std::vector<VkBufferImageCopy>& Ktx2Image::getRegions() const noexcept
+{
+    return m_regions;
+}
+
+
+std::vector<uint8_t> Ktx2Image::releaseStorage() noexcept
+{
+    return std::move(m_storage);
+}
\ No newline at end of file
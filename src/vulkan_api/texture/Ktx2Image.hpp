@@ -0,0 +1,59 @@
+#ifndef KTX2_IMAGE_HPP
+#define KTX2_IMAGE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// A KTX2 texture whose levels are copied to the GPU straight from the file contents, one copy region per level.
+// Only 2D textures without supercompression are read, Basis Universal and zstd files are rejected.
+// Block-compressed levels are uploaded as they are stored, unless the GPU can not sample the format,
+// then they are decoded to RGBA8 on the CPU.
+class Ktx2Image
+{
+public:
+    Ktx2Image() noexcept;
+
+//  Whether filepath names a KTX2 file, by its extension
+    static bool isKtx2File(const char* filepath) noexcept;
+
+    bool loadFromFile(const char* filepath) noexcept;
+
+//  Does not copy, data must outlive the image unless selectFormat() decodes it
+    bool loadFromMemory(const void* data, size_t size) noexcept;
+
+//  Keeps the stored format when GPU can sample it with linear filtering, otherwise decodes every level.
+//  Fails when the format is neither supported nor decodable
+    bool selectFormat(VkPhysicalDevice GPU) noexcept;
+
+    VkFormat getFormat()       const noexcept;
+    VkFormat getStoredFormat() const noexcept; // the format in the file
+    uint32_t getWidth()        const noexcept;
+    uint32_t getHeight()       const noexcept;
+    uint32_t getMipLevels()    const noexcept;
+    bool     isDecoded()       const noexcept; // selectFormat() fell back to the CPU
+
+//  Every level, bufferOffset of every region is relative to the start of the data
+    std::span<const uint8_t>              getData()    const noexcept;
+    const std::vector<VkBufferImageCopy>& getRegions() const noexcept;
+
+//  Moves out the memory the data points into, empty when it was borrowed by loadFromMemory().
+//  The data stays valid as long as the returned vector lives
+    std::vector<uint8_t> releaseStorage() noexcept;
+
+private:
+    bool parse(const uint8_t* bytes, size_t size) noexcept;
+
+    std::vector<uint8_t>           m_storage; // the file or the decoded levels, when the image owns them
+    std::span<const uint8_t>       m_data;
+    std::vector<VkBufferImageCopy> m_regions;
+    VkFormat                       m_format;
+    VkFormat                       m_storedFormat;
+    uint32_t                       m_width;
+    uint32_t                       m_height;
+    uint32_t                       m_mipLevels;
+};
+
+#endif // !KTX2_IMAGE_HPP
\ No newline at end of file
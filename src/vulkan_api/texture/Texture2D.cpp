@@ -1,7 +1,13 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <cstring>
+#include <vector>
+
+#include "utils/Trace.hpp"
 #include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/resources/UploadBatch.hpp"
+#include "vulkan_api/texture/Ktx2Image.hpp"
 #include "vulkan_api/texture/Texture2D.hpp"
 
 namespace
@@ -25,88 +31,203 @@ namespace
         int32_t  channels;
     };
 
-    struct BufferMemoryDeleter
+    VkBufferImageCopy make_copy_region(VkDeviceSize offset, uint32_t level, uint32_t width, uint32_t height) noexcept
     {
-        ~BufferMemoryDeleter() 
+        return VkBufferImageCopy
         {
-            if (buffer) vkDestroyBuffer(device, buffer, nullptr);
-            if (memory) vkFreeMemory(device, memory, nullptr);
-        }
-
-        VkDeviceMemory memory = nullptr;
-        VkBuffer buffer = nullptr;
-        VkDevice device = nullptr;
-    };
+            .bufferOffset      = offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageOffset       = { 0, 0, 0 },
+            .imageExtent       = { width, height, 1 }
+        };
+    }
 }
 
 
 
 Texture2D::Texture2D() noexcept:
-    m_imageMemory(nullptr),
+    m_imageMemory(),
     m_image(nullptr),
     m_imageView(nullptr),
-    m_sampler(nullptr)
+    m_sampler(nullptr),
+    m_mipLevels(1),
+    m_format(FORMAT)
 {
 
 }
 
 
-bool Texture2D::loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
+bool Texture2D::loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, UploadBatch& batch, bool mipmaps) noexcept
 {
+    TRACE_SCOPE("Texture2D::loadFromFile");
+
+    if(Ktx2Image::isKtx2File(filepath))
+    {
+        Ktx2Image image;
+
+        return image.loadFromFile(filepath) && image.selectFormat(GPU) && create(image, GPU, device, allocator, batch);
+    }
+
     StbImage stbImage(filepath, STBI_rgb_alpha);
 
     if ( ! stbImage.pixels )
         return false;
 
-    VkDeviceSize imageSize = stbImage.width * stbImage.height * 4;
-    
-    VkDeviceMemory stagingBufferMemory;
-    VkBuffer stagingBuffer = vk::createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBufferMemory, device, GPU);
+    return create(stbImage.pixels, static_cast<uint32_t>(stbImage.width), static_cast<uint32_t>(stbImage.height), GPU, device, allocator, batch, mipmaps);
+}
+
+
+bool Texture2D::create(const void* pixels, uint32_t width, uint32_t height, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, UploadBatch& batch, bool mipmaps) noexcept
+{
+    const uint32_t mipLevels = mipmaps ? vk::getMipLevelCount(width, height) : 1;
+
+//  the blit chain runs on the GPU, formats that can not be filtered by a blit get their levels built here instead
+    const bool blitMipmaps = (mipLevels > 1) && vk::supportsLinearBlit(FORMAT, GPU);
+
+    std::vector<VkBufferImageCopy> regions;
+    std::vector<uint8_t> mipChain;
+
+    if(mipLevels > 1 && !blitMipmaps)
+        mipChain = vk::buildMipChain(static_cast<const uint8_t*>(pixels), width, height, mipLevels, regions);
+    else
+        regions.push_back(make_copy_region(0, 0, width, height));
+
+    const void* uploadData = mipChain.empty() ? pixels : mipChain.data();
+    VkDeviceSize imageSize = mipChain.empty() ? static_cast<VkDeviceSize>(width) * height * 4 : mipChain.size();
+
+    UploadBatch::StagingRegion staging;
+
+    if ( ! batch.allocateStaging(imageSize, staging))
+        return false;
 
-    if(!stagingBuffer)
+    memcpy(staging.data, uploadData, static_cast<size_t>(imageSize));
+
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if(blitMipmaps)
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    if ( ! createStorage(width, height, mipLevels, usage, GPU, device, allocator))
+        return false;
+        
+    if ( ! batch.transitionImage(m_image, FORMAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels))
+    {
+        destroy(device, allocator);
         return false;
+    }
 
-    BufferMemoryDeleter guard = { stagingBufferMemory, stagingBuffer, device };
+    batch.copyBufferToImage(staging, m_image, regions);
 
-    if (void* data; vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data) == VK_SUCCESS)
+    if(blitMipmaps)
     {
-        memcpy(data, stbImage.pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(device, stagingBufferMemory);
+        vk::recordMipmapGeneration(batch.getCommandBuffer(), m_image, width, height, m_mipLevels);
+        return true;
     }
-    else return false;
 
-    if(vk::createImage2D(
-        stbImage.width, 
-        stbImage.height, 
-        VK_FORMAT_R8G8B8A8_SRGB, 
-        VK_IMAGE_TILING_OPTIMAL, 
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-        m_image, 
-        m_imageMemory, 
-        GPU, 
-        device) != VK_SUCCESS)
+    if ( ! batch.transitionImage(m_image, FORMAT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels))
+    {
+        destroy(device, allocator);
         return false;
-        
-    if ( ! vk::transitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, device, pool, queue))
+    }
+
+    return true;
+}
+
+
+bool Texture2D::create(const Ktx2Image& image, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, UploadBatch& batch) noexcept
+{
+    const auto data = image.getData();
+
+    UploadBatch::StagingRegion staging;
+
+    if ( ! batch.allocateStaging(data.size(), staging))
         return false;
 
-    if ( ! vk::copyBufferToImage(stagingBuffer, m_image, static_cast<uint32_t>(stbImage.width), static_cast<uint32_t>(stbImage.height), device, pool, queue))
+    memcpy(staging.data, data.data(), data.size());
+
+    if ( ! createStorage(image.getWidth(), image.getHeight(), image.getMipLevels(), VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, GPU, device, allocator, image.getFormat()))
         return false;
 
-    if ( ! vk::transitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, device, pool, queue))
+    if ( ! batch.transitionImage(m_image, m_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels))
+    {
+        destroy(device, allocator);
         return false;
+    }
+
+    batch.copyBufferToImage(staging, m_image, image.getRegions());
+
+    if ( ! batch.transitionImage(m_image, m_format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels))
+    {
+        destroy(device, allocator);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool Texture2D::createStorage(uint32_t width, uint32_t height, uint32_t mipLevels, VkImageUsageFlags usage, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, VkFormat format) noexcept
+{
+    m_mipLevels = mipLevels;
+    m_format    = format;
 
-    if(vk::createImageView2D(device, m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_imageView) != VK_SUCCESS)
+    if(vk::createImage2D(
+        width, 
+        height, 
+        m_format, 
+        VK_IMAGE_TILING_OPTIMAL, 
+        usage, 
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+        m_image, 
+        m_imageMemory, 
+        allocator,
+        m_mipLevels) != VK_SUCCESS)
         return false;
+
+    if(vk::createImageView2D(device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_imageView, m_mipLevels) != VK_SUCCESS)
+    {
+        m_imageView = nullptr; // not written by a failed create
+        destroy(device, allocator);
+        return false;
+    }
     
     if (createSampler(GPU, device) != VK_SUCCESS)
+    {
+        m_sampler = nullptr;
+        destroy(device, allocator);
         return false;
+    }
     
     return true;
 }
 
 
+VkImage Texture2D::getImage() const noexcept
+{
+    return m_image;
+}
+
+
+uint32_t Texture2D::getMipLevels() const noexcept
+{
+    return m_mipLevels;
+}
+
+
+VkFormat Texture2D::getFormat() const noexcept
+{
+    return m_format;
+}
+
+
+VkDeviceSize Texture2D::getMemorySize() const noexcept
+{
+    return m_imageMemory.size;
+}
+
+
 VkImageView Texture2D::getImageView() const noexcept
 {
     return m_imageView;
@@ -119,12 +240,15 @@ VkSampler Texture2D::getSampler() const noexcept
 }
 
 
-void Texture2D::destroy(VkDevice device) noexcept
+void Texture2D::destroy(VkDevice device, MemoryAllocator& allocator) noexcept
 {
     vkDestroySampler(device, m_sampler, nullptr);
     vkDestroyImageView(device, m_imageView, nullptr);
-    vkDestroyImage(device, m_image, nullptr);
-    vkFreeMemory(device, m_imageMemory, nullptr);
+    allocator.destroyImage(m_image, m_imageMemory);
+
+    m_sampler   = nullptr;
+    m_imageView = nullptr;
+    m_image     = nullptr;
 }
 
 
@@ -150,7 +274,7 @@ VkResult Texture2D::createSampler(VkPhysicalDevice GPU, VkDevice device) noexcep
         .compareEnable           = VK_FALSE,
         .compareOp               = VK_COMPARE_OP_ALWAYS,
         .minLod                  = 0.f,
-        .maxLod                  = 0.f,
+        .maxLod                  = static_cast<float>(m_mipLevels),
         .borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
         .unnormalizedCoordinates = VK_FALSE
     };
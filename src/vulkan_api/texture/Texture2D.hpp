@@ -3,24 +3,50 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+
 class Texture2D
 {
 public:
+    static constexpr VkFormat FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
     Texture2D() noexcept;
 
-    bool loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
-    void destroy(VkDevice device) noexcept;
+//  With mipmaps the full chain is generated at load time, by blits when the format supports linear filtering, on the CPU otherwise.
+//  KTX2 files keep their stored format and levels, mipmaps is ignored for them.
+//  The upload is recorded into batch, the texture can be sampled once the batch has completed
+    bool loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, class UploadBatch& batch, bool mipmaps = true) noexcept;
+
+//  pixels are tightly packed RGBA8 in sRGB and may be freed once this returns
+    bool create(const void* pixels, uint32_t width, uint32_t height, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, class UploadBatch& batch, bool mipmaps = true) noexcept;
+
+//  image must have been through Ktx2Image::selectFormat()
+    bool create(const class Ktx2Image& image, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, class UploadBatch& batch) noexcept;
 
+//  An uninitialized image with its view and sampler, the caller uploads every level and leaves them in SHADER_READ_ONLY_OPTIMAL.
+//  Like the create() variants it destroys whatever it created so far when a step fails
+    bool createStorage(uint32_t width, uint32_t height, uint32_t mipLevels, VkImageUsageFlags usage, VkPhysicalDevice GPU, VkDevice device, MemoryAllocator& allocator, VkFormat format = FORMAT) noexcept;
+
+    void destroy(VkDevice device, MemoryAllocator& allocator) noexcept;
+
+    VkImage     getImage() const noexcept;
     VkImageView getImageView() const noexcept;
     VkSampler   getSampler() const noexcept;
+    uint32_t    getMipLevels() const noexcept;
+    VkFormat    getFormat()    const noexcept;
+
+//  Device memory the image occupies
+    VkDeviceSize getMemorySize() const noexcept;
 
 private:
     VkResult createSampler(VkPhysicalDevice GPU, VkDevice device) noexcept;
 
-    VkDeviceMemory m_imageMemory;
-    VkImage        m_image;
-    VkImageView    m_imageView;
-    VkSampler      m_sampler;
+    MemoryAllocator::Allocation m_imageMemory;
+    VkImage                     m_image;
+    VkImageView                 m_imageView;
+    VkSampler                   m_sampler;
+    uint32_t                    m_mipLevels;
+    VkFormat                    m_format;
 };
 
 #endif // !TEXTURE2D_HPP
\ No newline at end of file
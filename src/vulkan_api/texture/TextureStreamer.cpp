@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include <stb_image.h>
+
+#include "utils/Trace.hpp"
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/texture/Ktx2Image.hpp"
+#include "vulkan_api/texture/TextureStreamer.hpp"
+
+
+TextureStreamer::TextureStreamer() noexcept:
+    m_GPU(nullptr),
+    m_device(nullptr),
+    m_allocator(nullptr),
+    m_transferQueue(nullptr),
+    m_transferQueueFamilyIndex(0),
+    m_mainQueueFamilyIndex(0),
+    m_commandPool(nullptr),
+    m_table(nullptr),
+    m_staging(nullptr),
+    m_placeholderView(nullptr),
+    m_placeholderSampler(nullptr),
+    m_transferTimeline(nullptr),
+    m_graphicsTimeline(nullptr),
+    m_archive(nullptr),
+    m_frame(0),
+    m_pending(0),
+    m_cancelled(false)
+{
+
+}
+
+
+bool TextureStreamer::create(VulkanContext& context, TextureTable& table, const Texture2D& placeholder, StagingRing& staging, SyncManager& sync, uint32_t workerCount, const AssetArchive* archive) noexcept
+{
+    m_GPU                      = context.getPhysicalDevice();
+    m_device                   = context.getDevice();
+    m_allocator                = &context.getAllocator();
+    m_transferQueue            = context.getTransferQueue();
+    m_transferQueueFamilyIndex = context.getTransferQueueFamilyIndex();
+    m_mainQueueFamilyIndex     = context.getMainQueueFamilyIndex();
+    m_table                    = &table;
+    m_staging                  = &staging;
+    m_archive                  = (archive && archive->isOpen()) ? archive : nullptr;
+    m_placeholderView          = placeholder.getImageView();
+    m_placeholderSampler       = placeholder.getSampler();
+    m_transferTimeline         = &sync.getTransferTimeline();
+    m_graphicsTimeline         = &sync.graphicsTimeline;
+
+    const VkCommandPoolCreateInfo poolInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = m_transferQueueFamilyIndex
+    };
+
+    if(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+        return false;
+
+    m_cancelled = false;
+    m_workers = std::make_unique<ThreadPool>(workerCount);
+
+    return true;
+}
+
+
+void TextureStreamer::destroy(VkDevice device) noexcept
+{
+    m_cancelled = true;
+    m_workers.reset();
+
+    for (auto& upload : m_uploads)
+    {
+        upload.batch.destroy();
+
+        for (auto& streamed : upload.textures)
+            streamed.texture.destroy(device, *m_allocator);
+    }
+
+    for (auto& [slot, entry] : m_entries)
+        if(entry.state == State::Resident)
+            entry.texture.destroy(device, *m_allocator);
+
+    for (auto& streamed : m_acquiring)
+        streamed.texture.destroy(device, *m_allocator);
+
+    for (auto& retired : m_retired)
+        retired.texture.destroy(device, *m_allocator);
+
+    if(m_commandPool)
+        vkDestroyCommandPool(device, m_commandPool, nullptr);
+
+    m_uploads.clear();
+    m_acquiring.clear();
+    m_entries.clear();
+    m_retired.clear();
+    m_decoded.clear();
+    m_failed.clear();
+    m_commandPool = nullptr;
+    m_pending = 0;
+}
+
+
+uint32_t TextureStreamer::request(const char* filepath, bool mipmaps) noexcept
+{
+    if(!m_workers)
+        return TextureTable::INVALID_INDEX;
+
+    const uint32_t slot = m_table->add(m_device, m_placeholderView, m_placeholderSampler);
+
+    if(slot == TextureTable::INVALID_INDEX)
+        return slot;
+
+    Entry& entry = m_entries[slot];
+    entry.path       = filepath;
+    entry.mipmaps    = mipmaps;
+    entry.state      = State::Loading;
+    entry.memorySize = 0;
+    entry.lastUsed   = m_frame;
+    entry.evictedAt  = 0;
+
+    load(slot, entry);
+
+    return slot;
+}
+
+
+uint32_t TextureStreamer::update(VkCommandBuffer cmd) noexcept
+{
+    TRACE_SCOPE("TextureStreamer::update");
+
+    uint32_t barrierCount = 0;
+    ++m_frame;
+
+//  frames recorded after the eviction bind sets without the texture, so it is free once the frames before it are done
+    for (size_t i = 0; i < m_retired.size();)
+    {
+        if(!m_graphicsTimeline->isComplete(m_retired[i].timelineValue))
+        {
+            ++i;
+            continue;
+        }
+
+        m_retired[i].texture.destroy(m_device, *m_allocator);
+        m_retired[i] = std::move(m_retired.back());
+        m_retired.pop_back();
+    }
+
+    if(const VkDeviceSize excess = m_allocator->getExcessBytes(); excess > 0)
+        evict(excess);
+    else
+        restore(m_allocator->getHeadroom());
+
+//  finished uploads first, so their staging memory is gone before new uploads allocate more
+    for (size_t i = 0; i < m_uploads.size();)
+    {
+        Upload& upload = m_uploads[i];
+
+        if(!upload.batch.isComplete())
+        {
+            ++i;
+            continue;
+        }
+
+        m_acquiring.insert(m_acquiring.end(), upload.textures.begin(), upload.textures.end());
+
+        m_uploads[i] = std::move(m_uploads.back());
+        m_uploads.pop_back();
+    }
+
+//  the acquire half of the ownership transfer, the release was submitted with the copy.
+//  Textures whose barrier was recorded into a frame that was dropped get it again
+    if(m_transferQueueFamilyIndex != m_mainQueueFamilyIndex)
+    {
+        for (const auto& streamed : m_acquiring)
+        {
+            VkImageMemoryBarrier barrier = makeOwnershipBarrier(streamed.texture.getImage(), streamed.texture.getMipLevels());
+            barrier.srcAccessMask = VK_ACCESS_NONE;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            ++barrierCount;
+        }
+    }
+
+    std::vector<DecodedImage> decoded;
+    std::vector<uint32_t> failed;
+
+    {
+        std::lock_guard lock(m_decodedMutex);
+
+        const size_t count = std::min<size_t>(m_decoded.size(), MAX_UPLOADS_PER_FRAME);
+        decoded.assign(std::make_move_iterator(m_decoded.begin()), std::make_move_iterator(m_decoded.begin() + count));
+        m_decoded.erase(m_decoded.begin(), m_decoded.begin() + count);
+        failed.swap(m_failed);
+    }
+
+//  the file will not decode any better next time, the slot keeps the placeholder for good
+    for (const uint32_t slot : failed)
+    {
+        m_entries[slot].state = State::Failed;
+        --m_pending;
+    }
+
+    if(!decoded.empty() && !submit(decoded))
+    {
+        printf("failed to upload %zu streamed textures, the placeholder stays in place\n", decoded.size());
+        m_pending -= static_cast<uint32_t>(decoded.size());
+
+//      retried like evicted textures once the delay has passed
+        for (const auto& image : decoded)
+        {
+            Entry& entry = m_entries[image.slot];
+            entry.state     = State::Evicted;
+            entry.evictedAt = m_frame;
+        }
+    }
+
+    return barrierCount;
+}
+
+
+void TextureStreamer::onFrameSubmitted() noexcept
+{
+//  the frame that acquired them is ahead of every frame that binds the updated table
+    for (const auto& streamed : m_acquiring)
+    {
+        m_table->update(streamed.slot, streamed.texture.getImageView(), streamed.texture.getSampler());
+
+        Entry& entry = m_entries[streamed.slot];
+        entry.texture    = streamed.texture;
+        entry.memorySize = streamed.texture.getMemorySize();
+        entry.state      = State::Resident;
+        --m_pending;
+    }
+
+    m_acquiring.clear();
+}
+
+
+void TextureStreamer::touch(uint32_t slot) noexcept
+{
+    if (auto it = m_entries.find(slot); it != m_entries.end())
+        it->second.lastUsed = m_frame;
+}
+
+
+uint32_t TextureStreamer::getPendingCount() const noexcept
+{
+    return m_pending;
+}
+
+
+uint32_t TextureStreamer::getEvictedCount() const noexcept
+{
+    return static_cast<uint32_t>(std::count_if(m_entries.begin(), m_entries.end(), [](const auto& it) { return it.second.state == State::Evicted; }));
+}
+
+
+uint32_t TextureStreamer::getFailedCount() const noexcept
+{
+    return static_cast<uint32_t>(std::count_if(m_entries.begin(), m_entries.end(), [](const auto& it) { return it.second.state == State::Failed; }));
+}
+
+
+void TextureStreamer::load(uint32_t slot, const Entry& entry) noexcept
+{
+    ++m_pending;
+
+    m_workers->submit([this, path = entry.path, slot, mipmaps = entry.mipmaps](uint32_t)
+    {
+        if(m_cancelled)
+            return;
+
+        TRACE_SCOPE("TextureStreamer::decode");
+
+        const std::span<const uint8_t> packed = m_archive ? m_archive->find(path) : std::span<const uint8_t>();
+
+        if(Ktx2Image::isKtx2File(path.c_str()))
+        {
+            Ktx2Image ktx;
+            const bool loaded = packed.empty() ? ktx.loadFromFile(path.c_str()) : ktx.loadFromMemory(packed.data(), packed.size());
+
+            if(!loaded || !ktx.selectFormat(m_GPU))
+            {
+                printf("failed to load %s, the placeholder stays in place\n", path.c_str());
+
+                std::lock_guard lock(m_decodedMutex);
+                m_failed.push_back(slot);
+
+                return;
+            }
+
+            DecodedImage image = {};
+            image.slot      = slot;
+            image.width     = ktx.getWidth();
+            image.height    = ktx.getHeight();
+            image.mipLevels = ktx.getMipLevels();
+            image.format    = ktx.getFormat();
+            image.regions   = ktx.getRegions();
+            image.data      = ktx.getData();
+            image.pixels    = ktx.releaseStorage(); // the vector keeps its buffer, data stays valid
+
+            std::lock_guard lock(m_decodedMutex);
+            m_decoded.push_back(std::move(image));
+
+            return;
+        }
+
+        int32_t width = 0, height = 0, channels = 0;
+        stbi_uc* pixels = packed.empty() ? stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha)
+                                         : stbi_load_from_memory(packed.data(), static_cast<int>(packed.size()), &width, &height, &channels, STBI_rgb_alpha);
+
+        if(!pixels)
+        {
+            printf("failed to decode %s, the placeholder stays in place\n", path.c_str());
+
+            std::lock_guard lock(m_decodedMutex);
+            m_failed.push_back(slot);
+
+            return;
+        }
+
+        DecodedImage image = {};
+        image.slot      = slot;
+        image.width     = static_cast<uint32_t>(width);
+        image.height    = static_cast<uint32_t>(height);
+        image.mipLevels = mipmaps ? vk::getMipLevelCount(image.width, image.height) : 1;
+        image.format    = Texture2D::FORMAT;
+
+//      the transfer queue can not blit, so the whole chain is built here
+        image.pixels = vk::buildMipChain(pixels, image.width, image.height, image.mipLevels, image.regions);
+        image.data   = image.pixels;
+        stbi_image_free(pixels);
+
+        std::lock_guard lock(m_decodedMutex);
+        m_decoded.push_back(std::move(image));
+    });
+}
+
+
+void TextureStreamer::evict(VkDeviceSize bytes) noexcept
+{
+//  the memory of the last eviction is not returned yet, the excess still counts it
+    if(!m_retired.empty())
+        return;
+
+    std::vector<uint32_t> resident;
+
+    for (const auto& [slot, entry] : m_entries)
+        if(entry.state == State::Resident)
+            resident.push_back(slot);
+
+    std::sort(resident.begin(), resident.end(), [this](uint32_t a, uint32_t b) { return m_entries[a].lastUsed < m_entries[b].lastUsed; });
+
+    VkDeviceSize evicted = 0;
+
+    for (const uint32_t slot : resident)
+    {
+        if(evicted >= bytes)
+            break;
+
+        Entry& entry = m_entries[slot];
+
+        m_table->update(slot, m_placeholderView, m_placeholderSampler);
+        m_retired.push_back({ entry.texture, m_graphicsTimeline->getLastValue() });
+
+        entry.texture   = Texture2D();
+        entry.state     = State::Evicted;
+        entry.evictedAt = m_frame;
+        evicted += entry.memorySize;
+    }
+
+    if(evicted)
+        printf("memory budget exceeded by %llu KiB, evicted %llu KiB of streamed textures\n", static_cast<unsigned long long>(bytes >> 10), static_cast<unsigned long long>(evicted >> 10));
+}
+
+
+void TextureStreamer::restore(VkDeviceSize headroom) noexcept
+{
+//  the most recently used texture first, and only one per frame since its size is only an estimate until it is resident
+    uint32_t candidate = TextureTable::INVALID_INDEX;
+
+    for (const auto& [slot, entry] : m_entries)
+    {
+        if(entry.state != State::Evicted || entry.lastUsed <= entry.evictedAt || m_frame < entry.evictedAt + RESTORE_DELAY_FRAMES)
+            continue;
+
+//      twice the size, so loading it does not immediately push the heap back over the mark
+        if(entry.memorySize * 2 > headroom)
+            continue;
+
+        if(candidate == TextureTable::INVALID_INDEX || entry.lastUsed > m_entries[candidate].lastUsed)
+            candidate = slot;
+    }
+
+    if(candidate == TextureTable::INVALID_INDEX)
+        return;
+
+    Entry& entry = m_entries[candidate];
+    entry.state = State::Loading;
+
+    load(candidate, entry);
+}
+
+
+bool TextureStreamer::submit(std::span<DecodedImage> images) noexcept
+{
+    Upload upload;
+
+    if(!upload.batch.begin(*m_allocator, m_device, m_commandPool, m_staging))
+        return false;
+
+    upload.textures.resize(images.size());
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        upload.textures[i].slot = images[i].slot;
+
+        if(!record(upload.batch, images[i], upload.textures[i].texture))
+        {
+            upload.batch.destroy();
+
+            for (size_t j = 0; j <= i; ++j)
+                upload.textures[j].texture.destroy(m_device, *m_allocator);
+
+            return false;
+        }
+    }
+
+    if(!upload.batch.submit(m_transferQueue, *m_transferTimeline))
+    {
+        for (auto& streamed : upload.textures)
+            streamed.texture.destroy(m_device, *m_allocator);
+
+        return false;
+    }
+
+    m_uploads.push_back(std::move(upload));
+
+    return true;
+}
+
+
+bool TextureStreamer::record(UploadBatch& batch, DecodedImage& image, Texture2D& texture) noexcept
+{
+    UploadBatch::StagingRegion staging;
+
+    if(!batch.allocateStaging(image.data.size(), staging))
+        return false;
+
+    memcpy(staging.data, image.data.data(), image.data.size());
+
+    if(!texture.createStorage(image.width, image.height, image.mipLevels, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, m_GPU, m_device, *m_allocator, image.format))
+        return false;
+
+    const VkImage handle = texture.getImage();
+
+    if(!batch.transitionImage(handle, image.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image.mipLevels))
+        return false;
+
+    batch.copyBufferToImage(staging, handle, image.regions);
+
+//  one queue, a plain transition makes the copy visible to every later frame
+    if(m_transferQueueFamilyIndex == m_mainQueueFamilyIndex)
+        return batch.transitionImage(handle, image.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image.mipLevels);
+
+//  the release half, the destination access happens on the main queue
+    VkImageMemoryBarrier barrier = makeOwnershipBarrier(handle, image.mipLevels);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_NONE;
+
+    vkCmdPipelineBarrier(batch.getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    return true;
+}
+
+
+VkImageMemoryBarrier TextureStreamer::makeOwnershipBarrier(VkImage image, uint32_t mipLevels) const noexcept
+{
+    return VkImageMemoryBarrier
+    {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VK_ACCESS_NONE,
+        .dstAccessMask       = VK_ACCESS_NONE,
+        .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = m_transferQueueFamilyIndex,
+        .dstQueueFamilyIndex = m_mainQueueFamilyIndex,
+        .image               = image,
+        .subresourceRange    = 
+        {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount     = 1
+        }
+    };
+}
\ No newline at end of file
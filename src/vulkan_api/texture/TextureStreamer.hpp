@@ -0,0 +1,157 @@
+#ifndef TEXTURE_STREAMER_HPP
+#define TEXTURE_STREAMER_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "utils/AssetArchive.hpp"
+#include "utils/ThreadPool.hpp"
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/resources/UploadBatch.hpp"
+#include "vulkan_api/sync/SyncManager.hpp"
+#include "vulkan_api/texture/Texture2D.hpp"
+#include "vulkan_api/texture/TextureTable.hpp"
+
+// Loads textures from disk without stalling the render loop.
+// Files are decoded and their mip chains built on worker threads, KTX2 files keep their stored, usually block-compressed,
+// levels. Paths found in the asset archive are read from its mapping, KTX2 levels are copied from there straight into staging memory. The render thread only submits the copies of everything decoded since the last frame as one UploadBatch,
+// on the transfer queue family when the context found a dedicated one. The images are then released to the main family and acquired by the first frame submitted after
+// the batch completed. Until that frame the texture's slot in the table shows the placeholder.
+// When device-local memory runs over its budget the least recently used textures are evicted back to the placeholder,
+// and loaded again from disk once there is room for them and they are still in use.
+class TextureStreamer
+{
+public:
+    static constexpr uint32_t MAX_UPLOADS_PER_FRAME = 4;
+
+//  An evicted texture is not loaded again for this many frames, so a heap close to its budget does not thrash
+    static constexpr uint64_t RESTORE_DELAY_FRAMES  = 120;
+
+    TextureStreamer() noexcept;
+
+//  archive may be null or closed, it must stay open until destroy(). Uploads are submitted on the transfer timeline of sync,
+//  evicted textures are destroyed once the graphics timeline has passed the last frame that could sample them
+    bool create(VulkanContext& context, TextureTable& table, const Texture2D& placeholder, StagingRing& staging, SyncManager& sync, uint32_t workerCount, const AssetArchive* archive = nullptr) noexcept;
+
+//  The device must be idle, decodes that have not started yet are dropped
+    void destroy(VkDevice device) noexcept;
+
+//  Returns the table slot of the texture right away, TextureTable::INVALID_INDEX when the table is full.
+//  A file that fails to decode keeps showing the placeholder and is not loaded again
+    uint32_t request(const char* filepath, bool mipmaps) noexcept;
+
+//  Once per frame on the render thread, before rendering begins: submits decoded textures and hands finished ones
+//  to the main queue family with barriers recorded into cmd. Returns the number of barriers recorded
+//  Evictions and restores follow the budget of the last MemoryAllocator::updateBudget()
+    uint32_t update(VkCommandBuffer cmd) noexcept;
+
+//  After cmd of the last update() was submitted: the textures it acquired replace the placeholder in the table.
+//  A frame that never reaches the queue does not call it, the next update() records the same barriers again
+    void onFrameSubmitted() noexcept;
+
+//  Marks the texture in slot as used by the frame being recorded
+    void touch(uint32_t slot) noexcept;
+
+//  Requested textures that are not resident yet
+    uint32_t getPendingCount() const noexcept;
+
+//  Textures that were evicted and have not been loaded again
+    uint32_t getEvictedCount() const noexcept;
+
+//  Textures whose file could not be read or decoded
+    uint32_t getFailedCount() const noexcept;
+
+private:
+    struct DecodedImage
+    {
+        uint32_t                       slot;
+        uint32_t                       width;
+        uint32_t                       height;
+        uint32_t                       mipLevels;
+        VkFormat                       format;
+        std::vector<uint8_t>           pixels; // owns the levels unless they live in the archive
+        std::span<const uint8_t>       data;   // every level, into pixels or the archive
+        std::vector<VkBufferImageCopy> regions;
+    };
+
+    enum class State : uint32_t
+    {
+        Loading,
+        Resident,
+        Evicted,
+        Failed
+    };
+
+//  Everything needed to load a texture again after it was evicted
+    struct Entry
+    {
+        std::string  path;
+        bool         mipmaps;
+        State        state;
+        Texture2D    texture;
+        VkDeviceSize memorySize; // kept after eviction to know whether the texture fits back in
+        uint64_t     lastUsed;
+        uint64_t     evictedAt;
+    };
+
+    struct StreamedTexture
+    {
+        uint32_t  slot;
+        Texture2D texture;
+    };
+
+    struct RetiredTexture
+    {
+        Texture2D texture;
+        uint64_t  timelineValue; // of the last frame submitted before the eviction
+    };
+
+    struct Upload
+    {
+        UploadBatch                  batch;
+        std::vector<StreamedTexture> textures;
+    };
+
+    void load(uint32_t slot, const Entry& entry) noexcept;
+    void evict(VkDeviceSize bytes) noexcept;
+    void restore(VkDeviceSize headroom) noexcept;
+    bool submit(std::span<DecodedImage> images) noexcept;
+    bool record(UploadBatch& batch, DecodedImage& image, Texture2D& texture) noexcept;
+    VkImageMemoryBarrier makeOwnershipBarrier(VkImage image, uint32_t mipLevels) const noexcept;
+
+    VkPhysicalDevice m_GPU;
+    VkDevice         m_device;
+    MemoryAllocator* m_allocator;
+    VkQueue          m_transferQueue;
+    uint32_t         m_transferQueueFamilyIndex;
+    uint32_t         m_mainQueueFamilyIndex;
+    VkCommandPool    m_commandPool;
+    TextureTable*    m_table;
+    StagingRing*     m_staging;
+    VkImageView      m_placeholderView;
+    VkSampler        m_placeholderSampler;
+    TimelineSemaphore* m_transferTimeline;
+    TimelineSemaphore* m_graphicsTimeline;
+
+    const AssetArchive*         m_archive;  // paths are looked up here before the disk
+    std::unique_ptr<ThreadPool> m_workers;
+    std::mutex                  m_decodedMutex;
+    std::vector<DecodedImage>   m_decoded;  // filled by the workers
+    std::vector<uint32_t>       m_failed;   // slots the workers could not decode, guarded by m_decodedMutex
+    std::vector<Upload>         m_uploads;  // submitted, waiting for their batch
+    std::vector<StreamedTexture> m_acquiring; // copied, waiting for the frame that acquires them to be submitted
+    std::unordered_map<uint32_t, Entry> m_entries; // by table slot
+    std::vector<RetiredTexture> m_retired;  // evicted, frames in flight may still sample them
+    uint64_t                    m_frame;
+    std::atomic<uint32_t>       m_pending;
+    std::atomic<bool>           m_cancelled;
+};
+
+#endif // !TEXTURE_STREAMER_HPP
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include <algorithm>
+
+#include "vulkan_api/texture/TextureTable.hpp"
+
+
+TextureTable::TextureTable() noexcept:
+    m_layout(nullptr),
+    m_pool(nullptr),
+    m_sets{},
+    m_capacity(0),
+    m_count(0)
+{
+
+}
+
+
+bool TextureTable::create(VkPhysicalDevice GPU, VkDevice device) noexcept
+{
+    VkPhysicalDeviceVulkan12Properties properties12 = {};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2 = {};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &properties12;
+
+    vkGetPhysicalDeviceProperties2(GPU, &properties2);
+
+//  a combined image sampler counts against both the sampled image and the sampler limits,
+//  and the pool holds one copy of the set per frame in flight
+    m_capacity = std::min(
+    {
+        MAX_TEXTURES,
+        properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+        properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+        properties12.maxDescriptorSetUpdateAfterBindSamplers,
+        properties12.maxUpdateAfterBindDescriptorsInAllPools / MAX_FRAMES_IN_FLIGHT
+    });
+
+    if(m_capacity == 0)
+        return false;
+
+    const VkDescriptorSetLayoutBinding binding = 
+    {
+        .binding            = 0,
+        .descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount    = m_capacity,
+        .stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .pImmutableSamplers = nullptr
+    };
+
+    const VkDescriptorBindingFlags bindingFlags = 
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | 
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | 
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext         = nullptr,
+        .bindingCount  = 1,
+        .pBindingFlags = &bindingFlags
+    };
+
+    const VkDescriptorSetLayoutCreateInfo layoutInfo = 
+    {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext        = &bindingFlagsInfo,
+        .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = 1,
+        .pBindings    = &binding
+    };
+
+    if(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+        return false;
+
+    const VkDescriptorPoolSize poolSize = 
+    {
+        .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = m_capacity * MAX_FRAMES_IN_FLIGHT
+    };
+
+    const VkDescriptorPoolCreateInfo poolInfo = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext         = nullptr,
+        .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets       = MAX_FRAMES_IN_FLIGHT,
+        .poolSizeCount = 1,
+        .pPoolSizes    = &poolSize
+    };
+
+    if(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+    {
+        destroy(device);
+        return false;
+    }
+
+    std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts;
+    layouts.fill(m_layout);
+
+    const VkDescriptorSetAllocateInfo allocateInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext              = nullptr,
+        .descriptorPool     = m_pool,
+        .descriptorSetCount = MAX_FRAMES_IN_FLIGHT,
+        .pSetLayouts        = layouts.data()
+    };
+
+    if(vkAllocateDescriptorSets(device, &allocateInfo, m_sets.data()) != VK_SUCCESS)
+    {
+        destroy(device);
+        return false;
+    }
+
+    return true;
+}
+
+
+void TextureTable::destroy(VkDevice device) noexcept
+{
+    if(m_pool)
+        vkDestroyDescriptorPool(device, m_pool, nullptr);
+
+    if(m_layout)
+        vkDestroyDescriptorSetLayout(device, m_layout, nullptr);
+
+    m_pool     = nullptr;
+    m_layout   = nullptr;
+    m_sets     = {};
+    m_capacity = 0;
+    m_count    = 0;
+    m_pending.clear();
+}
+
+
+uint32_t TextureTable::add(VkDevice device, VkImageView imageView, VkSampler sampler) noexcept
+{
+    if(!m_pool || m_count == m_capacity)
+        return INVALID_INDEX;
+
+    const VkDescriptorImageInfo imageInfo = 
+    {
+        .sampler     = sampler,
+        .imageView   = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+//  no command buffer can reference a slot before it is handed out, so every copy is written right away
+    const uint32_t index = m_count++;
+
+    for (auto set : m_sets)
+        write(device, set, index, imageInfo);
+
+    return index;
+}
+
+
+void TextureTable::update(uint32_t index, VkImageView imageView, VkSampler sampler) noexcept
+{
+    if(index >= m_count)
+        return;
+
+    const VkDescriptorImageInfo imageInfo = 
+    {
+        .sampler     = sampler,
+        .imageView   = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    constexpr uint32_t allFrames = (1U << MAX_FRAMES_IN_FLIGHT) - 1;
+
+    for (auto& pending : m_pending)
+    {
+        if(pending.index == index)
+        {// the newer descriptor wins, frames that already took the older one need the write again
+            pending.imageInfo = imageInfo;
+            pending.frameMask = allFrames;
+
+            return;
+        }
+    }
+
+    m_pending.push_back({ index, imageInfo, allFrames });
+}
+
+
+void TextureTable::flush(VkDevice device, uint32_t frame) noexcept
+{
+    const uint32_t frameBit = 1U << frame;
+
+    for (auto& pending : m_pending)
+    {
+        if(pending.frameMask & frameBit)
+        {
+            write(device, m_sets[frame], pending.index, pending.imageInfo);
+            pending.frameMask &= ~frameBit;
+        }
+    }
+
+    std::erase_if(m_pending, [](const PendingUpdate& pending) { return pending.frameMask == 0; });
+}
+
+
+void TextureTable::write(VkDevice device, VkDescriptorSet set, uint32_t index, const VkDescriptorImageInfo& imageInfo) noexcept
+{
+    const VkWriteDescriptorSet descriptorWrite = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = nullptr,
+        .dstSet           = set,
+        .dstBinding       = 0,
+        .dstArrayElement  = index,
+        .descriptorCount  = 1,
+        .descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo       = &imageInfo,
+        .pBufferInfo      = nullptr,
+        .pTexelBufferView = nullptr
+    };
+
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+
+
+uint32_t TextureTable::getCount() const noexcept
+{
+    return m_count;
+}
+
+
+uint32_t TextureTable::getCapacity() const noexcept
+{
+    return m_capacity;
+}
+
+
+VkDescriptorSetLayout TextureTable::getLayout() const noexcept
+{
+    return m_layout;
+}
+
+
+VkDescriptorSet TextureTable::getSet(uint32_t frame) const noexcept
+{
+    return m_sets[frame];
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef TEXTURE_TABLE_HPP
+#define TEXTURE_TABLE_HPP
+
+#include <array>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vulkan_api/utils/Defines.hpp"
+
+// Global bindless array of combined image samplers, bound once per frame as its own descriptor set and indexed from shaders.
+// The binding is partially bound and update-after-bind: unused slots may stay empty, and slots no pending command buffer
+// reads may be written at any time. Every frame in flight owns a copy of the set, so a slot that is already sampled
+// can be redirected with update(), each copy is rewritten once its frame comes around again.
+class TextureTable
+{
+public:
+    static constexpr uint32_t MAX_TEXTURES  = 1024;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    TextureTable() noexcept;
+
+//  Requires VulkanContext::Features::descriptorIndexing, the capacity is clamped to the update-after-bind limits of the GPU
+    bool create(VkPhysicalDevice GPU, VkDevice device) noexcept;
+    void destroy(VkDevice device) noexcept;
+
+//  Returns the slot shaders index the texture with, INVALID_INDEX when the table is full
+    uint32_t add(VkDevice device, VkImageView imageView, VkSampler sampler) noexcept;
+
+//  Deferred until flush() of each frame, the previous image view must stay alive for MAX_FRAMES_IN_FLIGHT frames
+    void     update(uint32_t index, VkImageView imageView, VkSampler sampler) noexcept;
+
+//  Applies pending updates to the set of this frame, call after its timeline value was waited on and before the set is bound
+    void     flush(VkDevice device, uint32_t frame) noexcept;
+
+    uint32_t              getCount()    const noexcept;
+    uint32_t              getCapacity() const noexcept;
+    VkDescriptorSetLayout getLayout()   const noexcept;
+    VkDescriptorSet       getSet(uint32_t frame) const noexcept;
+
+private:
+    struct PendingUpdate
+    {
+        uint32_t              index;
+        VkDescriptorImageInfo imageInfo;
+        uint32_t              frameMask; // frames whose set still shows the old descriptor
+    };
+
+    void write(VkDevice device, VkDescriptorSet set, uint32_t index, const VkDescriptorImageInfo& imageInfo) noexcept;
+
+    VkDescriptorSetLayout m_layout;
+    VkDescriptorPool      m_pool;
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_sets;
+    std::vector<PendingUpdate> m_pending;
+    uint32_t              m_capacity;
+    uint32_t              m_count;
+};
+
+#endif // !TEXTURE_TABLE_HPP
\ No newline at end of file
@@ -1,28 +1,49 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 
+#include "utils/Trace.hpp"
 #include "vulkan_api/utils/Helpers.hpp"
 
 
-BEGIN_NAMESPACE_VK
-
-uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice GPU) noexcept
+namespace
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(GPU, &memProperties);
+    float srgb_to_linear(uint8_t value) noexcept
+    {
+        const float c = value / 255.f;
+
+        return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+
+    uint8_t linear_to_srgb(float value) noexcept
     {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
+        const float c = (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+
+        return static_cast<uint8_t>(std::clamp(c * 255.f + 0.5f, 0.f, 255.f));
     }
 
-    return 0;
+
+    VkBufferImageCopy make_level_copy(VkDeviceSize offset, uint32_t level, uint32_t width, uint32_t height) noexcept
+    {
+        return VkBufferImageCopy
+        {
+            .bufferOffset      = offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource  = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageOffset       = { 0, 0, 0 },
+            .imageExtent       = { width, height, 1 }
+        };
+    }
 }
 
 
+BEGIN_NAMESPACE_VK
+
 VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool pool) noexcept
 {
     VkCommandBufferAllocateInfo allocInfo = 
@@ -56,107 +77,130 @@ VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool pool) noe
 }
 
 
-void endSingleTimeCommands(VkCommandBuffer cmd, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
+void endSingleTimeCommands(VkCommandBuffer cmd, VkDevice device, VkCommandPool pool, VkQueue queue, TimelineSemaphore& timeline) noexcept
 {
+    TRACE_SCOPE("endSingleTimeCommands"); // submit + wait for its timeline value, only the frame dump readback goes through here
+
     vkEndCommandBuffer(cmd);
 
+    const uint64_t    signalValue     = timeline.peek();
+    const VkSemaphore signalSemaphore = timeline.getHandle();
+
+    const VkTimelineSemaphoreSubmitInfo timelineInfo = 
+    {
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext                     = nullptr,
+        .waitSemaphoreValueCount   = 0,
+        .pWaitSemaphoreValues      = nullptr,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues    = &signalValue
+    };
+
     VkSubmitInfo submitInfo = 
     {
         .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext                = nullptr,
+        .pNext                = &timelineInfo,
         .waitSemaphoreCount   = 0,
         .pWaitSemaphores      = nullptr,
         .pWaitDstStageMask    = nullptr,
         .commandBufferCount   = 1,
         .pCommandBuffers      = &cmd,
-        .signalSemaphoreCount = 0,
-        .pSignalSemaphores    = nullptr
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &signalSemaphore
     };
 
-    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(queue);
+    if(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS)
+    {
+        timeline.commit(signalValue);
+        timeline.wait(signalValue);
+    }
+
     vkFreeCommandBuffers(device, pool, 1, &cmd);
 }
 
 
-VkBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceMemory& bufferMemory, VkDevice device, VkPhysicalDevice GPU) noexcept
+bool recordImageTransition(VkCommandBuffer cmd, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) noexcept
 {
-    VkBufferCreateInfo bufferInfo = 
-    {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0,
-        .size = size,
-        .usage = usage,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 0,
-        .pQueueFamilyIndices = nullptr
-    };
-
-    VkBuffer buffer;
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
-        return nullptr;
+    if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+        aspectMask = hasStencilComponent(format) ? (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT) : VK_IMAGE_ASPECT_DEPTH_BIT;
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo = 
+    VkImageMemoryBarrier barrier = 
     {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext           = nullptr,
-        .allocationSize  = memRequirements.size,
-        .memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties, GPU)
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VK_ACCESS_NONE,
+        .dstAccessMask       = VK_ACCESS_NONE,
+        .oldLayout           = oldLayout,
+        .newLayout           = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = image,
+        .subresourceRange    = 
+        {
+            .aspectMask     = aspectMask,
+            .baseMipLevel   = 0,
+            .levelCount     = mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount     = 1
+        }
     };
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+    VkPipelineStageFlags sourceStage;
+    VkPipelineStageFlags destinationStage;
+
+    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
     {
-        vkDestroyBuffer(device, buffer, nullptr);
+        barrier.srcAccessMask = VK_ACCESS_NONE;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
-        return nullptr;
+        sourceStage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     }
-    
-    if(vkBindBufferMemory(device, buffer, bufferMemory, 0) != VK_SUCCESS)
+    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
     {
-        vkFreeMemory(device, bufferMemory, nullptr);
-        vkDestroyBuffer(device, buffer, nullptr);
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        return nullptr;
+        sourceStage      = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     }
-
-    return buffer;
-}
-
-
-void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
-{
-    if(VkCommandBuffer cmd = beginSingleTimeCommands(device, pool))
+    else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
     {
-        VkBufferCopy copyRegion = 
-        {
-            .srcOffset = 0,
-            .dstOffset = 0,
-            .size = size
-        };
+        barrier.srcAccessMask = VK_ACCESS_NONE;
+        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-        vkCmdCopyBuffer(cmd, srcBuffer, dstBuffer, 1, &copyRegion);
-        endSingleTimeCommands(cmd, device, pool, queue);
+        sourceStage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     }
+    else return false; // unsupported transition
+
+    vkCmdPipelineBarrier(
+        cmd,
+        sourceStage, destinationStage,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+
+    return true;
 }
 
 
-bool transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
+// layout is the current layout of a color image that is done being rendered, it is left in TRANSFER_SRC_OPTIMAL
+bool copyImageToBuffer(VkImage image, VkImageLayout layout, VkBuffer buffer, uint32_t width, uint32_t height, VkDevice device, VkCommandPool pool, VkQueue queue, TimelineSemaphore& timeline) noexcept
 {
     if(VkCommandBuffer cmd = vk::beginSingleTimeCommands(device, pool))
     {
-        VkImageMemoryBarrier barrier = 
+        const VkImageMemoryBarrier barrier = 
         {
             .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
             .pNext               = nullptr,
-            .srcAccessMask       = VK_ACCESS_NONE,
-            .dstAccessMask       = VK_ACCESS_NONE,
-            .oldLayout           = oldLayout,
-            .newLayout           = newLayout,
+            .srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout           = layout,
+            .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .image               = image,
@@ -170,56 +214,8 @@ bool transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
             }
         };
 
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
-
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-        {
-            barrier.srcAccessMask = VK_ACCESS_NONE;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            sourceStage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        }
-        else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage      = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-        {
-            barrier.srcAccessMask = VK_ACCESS_NONE;
-            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            sourceStage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        }
-        else return false; // unsupported transition
-
-        vkCmdPipelineBarrier(
-            cmd,
-            sourceStage, destinationStage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
-
-        vk::endSingleTimeCommands(cmd, device, pool, queue);
-
-        return true;
-    }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-    return false;
-}
-
-
-bool copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
-{
-    if(VkCommandBuffer cmd = vk::beginSingleTimeCommands(device, pool))
-    {
         VkBufferImageCopy region = 
         {
             .bufferOffset      = 0,
@@ -246,8 +242,8 @@ bool copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t
             }
         };
 
-        vkCmdCopyBufferToImage(cmd, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-        vk::endSingleTimeCommands(cmd, device, pool, queue);
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+        vk::endSingleTimeCommands(cmd, device, pool, queue, timeline);
 
         return true;
     }
@@ -256,11 +252,9 @@ bool copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t
 }
 
 
-VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, VkPhysicalDevice GPU, VkDevice device) noexcept
+VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocator::Allocation& allocation, MemoryAllocator& allocator, uint32_t mipLevels) noexcept
 {
-    VkResult result = VK_SUCCESS;
-
-    VkImageCreateInfo imageInfo = 
+    const VkImageCreateInfo imageInfo = 
     {
         .sType     = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .pNext     = nullptr,
@@ -273,7 +267,7 @@ VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImage
             .height = height,
             .depth  = 1
         },
-        .mipLevels             = 1,
+        .mipLevels             = mipLevels,
         .arrayLayers           = 1,
         .samples               = VK_SAMPLE_COUNT_1_BIT,
         .tiling                = tiling,
@@ -284,28 +278,11 @@ VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImage
         .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
     };
 
-    if (result = vkCreateImage(device, &imageInfo, nullptr, &image); result == VK_SUCCESS)
-    {
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo = 
-        {
-            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .pNext           = nullptr,
-            .allocationSize  = memRequirements.size,
-            .memoryTypeIndex = vk::findMemoryType(memRequirements.memoryTypeBits, properties, GPU)
-        };
-
-        if (result = vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory); result == VK_SUCCESS)
-            result = vkBindImageMemory(device, image, imageMemory, 0);
-    }
-
-    return result;
+    return allocator.createImage(imageInfo, properties, image, allocation);
 }
 
 
-VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView) noexcept
+VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView, uint32_t mipLevels) noexcept
 {
     VkImageViewCreateInfo viewInfo = 
     {
@@ -326,7 +303,7 @@ VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkIm
         {
             .aspectMask     = aspectFlags,
             .baseMipLevel   = 0,
-            .levelCount     = 1,
+            .levelCount     = mipLevels,
             .baseArrayLayer = 0,
             .layerCount     = 1
         }
@@ -336,6 +313,169 @@ VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkIm
 }
 
 
+uint32_t getMipLevelCount(uint32_t width, uint32_t height) noexcept
+{
+    uint32_t levels = 1;
+
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+        ++levels;
+
+    return levels;
+}
+
+
+bool supportsLinearBlit(VkFormat format, VkPhysicalDevice GPU) noexcept
+{
+    constexpr VkFormatFeatureFlags features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(GPU, format, &props);
+
+    return (props.optimalTilingFeatures & features) == features;
+}
+
+
+void recordMipmapGeneration(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels) noexcept
+{
+    VkImageMemoryBarrier barrier = 
+    {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext               = nullptr,
+        .srcAccessMask       = VK_ACCESS_NONE,
+        .dstAccessMask       = VK_ACCESS_NONE,
+        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = image,
+        .subresourceRange    = 
+        {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = 1,
+            .baseArrayLayer = 0,
+            .layerCount     = 1
+        }
+    };
+
+    int32_t mipWidth  = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+//      the source level was just written, either by the upload or by the previous blit
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        const int32_t nextWidth  = std::max(mipWidth / 2, 1);
+        const int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+        const VkImageBlit blit = 
+        {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+            .srcOffsets     = { { 0, 0, 0 }, { mipWidth, mipHeight, 1 } },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .dstOffsets     = { { 0, 0, 0 }, { nextWidth, nextHeight, 1 } }
+        };
+
+        vkCmdBlitImage(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        mipWidth  = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+//  the last level is only ever a blit destination
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+
+std::vector<uint8_t> buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<VkBufferImageCopy>& regions) noexcept
+{
+    std::array<float, 256> toLinear;
+
+    for (size_t i = 0; i < toLinear.size(); ++i)
+        toLinear[i] = srgb_to_linear(static_cast<uint8_t>(i));
+
+    size_t totalSize = 0;
+
+    for (uint32_t level = 0, w = width, h = height; level < mipLevels; ++level, w = std::max(w / 2, 1U), h = std::max(h / 2, 1U))
+        totalSize += static_cast<size_t>(w) * h * 4;
+
+    std::vector<uint8_t> chain(totalSize);
+    memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+    regions.push_back(make_level_copy(0, 0, width, height));
+
+    size_t srcOffset = 0;
+    size_t dstOffset = static_cast<size_t>(width) * height * 4;
+    uint32_t srcWidth = width;
+    uint32_t srcHeight = height;
+
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+        const uint32_t dstWidth  = std::max(srcWidth / 2, 1U);
+        const uint32_t dstHeight = std::max(srcHeight / 2, 1U);
+
+        const uint8_t* src = chain.data() + srcOffset;
+        uint8_t* dst = chain.data() + dstOffset;
+
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+//          odd sizes and 1 texel wide levels clamp to the last row or column
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+
+                const uint8_t* texels[4] = 
+                {
+                    src + (static_cast<size_t>(y0) * srcWidth + x0) * 4,
+                    src + (static_cast<size_t>(y0) * srcWidth + x1) * 4,
+                    src + (static_cast<size_t>(y1) * srcWidth + x0) * 4,
+                    src + (static_cast<size_t>(y1) * srcWidth + x1) * 4
+                };
+
+                uint8_t* out = dst + (static_cast<size_t>(y) * dstWidth + x) * 4;
+
+                for (int c = 0; c < 3; ++c)
+                    out[c] = linear_to_srgb(0.25f * (toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]]));
+
+                out[3] = static_cast<uint8_t>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+            }
+        }
+
+        regions.push_back(make_level_copy(dstOffset, level, dstWidth, dstHeight));
+
+        srcOffset = dstOffset;
+        dstOffset += static_cast<size_t>(dstWidth) * dstHeight * 4;
+        srcWidth  = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    return chain;
+}
+
+
 VkFormat findSupportedFormat(std::span<const VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features, VkPhysicalDevice GPU) noexcept
 {
     for (VkFormat format : candidates)
@@ -3,29 +3,42 @@
 
 #include <cstdint>
 #include <span>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 
 #include "vulkan_api/utils/Defines.hpp"
+#include "vulkan_api/memory/MemoryAllocator.hpp"
+#include "vulkan_api/sync/TimelineSemaphore.hpp"
 
 BEGIN_NAMESPACE_VK
 
 
-uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice GPU) noexcept;
+VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool pool) noexcept;
+void endSingleTimeCommands(VkCommandBuffer cmd, VkDevice device, VkCommandPool pool, VkQueue queue, TimelineSemaphore& timeline) noexcept;
 
 
-VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool pool) noexcept;
-void endSingleTimeCommands(VkCommandBuffer cmd, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
+//  The record* variants only record into cmd, see UploadBatch for submitting many of them at once.
+//  copyImageToBuffer records into its own command buffer and waits until the queue's timeline reaches its submit
+bool recordImageTransition(VkCommandBuffer cmd, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1) noexcept;
+bool copyImageToBuffer(VkImage image, VkImageLayout layout, VkBuffer buffer, uint32_t width, uint32_t height, VkDevice device, VkCommandPool pool, VkQueue queue, TimelineSemaphore& timeline) noexcept;
+VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocator::Allocation& allocation, MemoryAllocator& allocator, uint32_t mipLevels = 1) noexcept;
+VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView, uint32_t mipLevels = 1) noexcept;
+
 
+//  Full chain down to 1x1
+uint32_t getMipLevelCount(uint32_t width, uint32_t height) noexcept;
 
-VkBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceMemory& bufferMemory, VkDevice device, VkPhysicalDevice GPU) noexcept;
-void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
+//  Whether vkCmdBlitImage with VK_FILTER_LINEAR can downsample an optimally tiled image of this format
+bool supportsLinearBlit(VkFormat format, VkPhysicalDevice GPU) noexcept;
 
+//  Blits every level from the previous one, level 0 must be filled and all levels in TRANSFER_DST_OPTIMAL,
+//  the whole chain ends up in SHADER_READ_ONLY_OPTIMAL. The image needs TRANSFER_SRC and TRANSFER_DST usage
+void recordMipmapGeneration(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels) noexcept;
 
-bool transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
-bool copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
-VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, VkPhysicalDevice GPU, VkDevice device) noexcept;
-VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView) noexcept;
+//  CPU mip chain of an sRGB RGBA8 image for formats or queues without linear blits: a 2x2 box filter in linear space.
+//  Levels are packed back to back, one copy region per level is appended to regions
+std::vector<uint8_t> buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<VkBufferImageCopy>& regions) noexcept;
 
 
 VkFormat findSupportedFormat(std::span<const VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features, VkPhysicalDevice GPU) noexcept;